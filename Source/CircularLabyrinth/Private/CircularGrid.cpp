@@ -1,10 +1,42 @@
 #include "CircularGrid.h"
 
+#include "EngineUtils.h"
 #include "Kismet/GameplayStatics.h"
 #include "Kismet/KismetMathLibrary.h"
 #include "Math/UnrealMathUtility.h"
+#include "Async/ParallelFor.h"
+#include "Misc/Compression.h"
+#include "Net/UnrealNetwork.h"
+#include "LabyrinthNavData.h"
+#include "LabyrinthNetRelay.h"
+#include "Algo/Reverse.h"
 #include "Runtime/Windows/D3D11RHI/Public/Windows/D3D11ThirdParty.h"
 
+DEFINE_LOG_CATEGORY_STATIC(LogCircularGrid, Log, All);
+
+// Debug command to test runtime wall changes on a listen server: Labyrinth.SetWallOpen <WallIndex> <0|1>
+static FAutoConsoleCommandWithWorldAndArgs CmdLabyrinthSetWallOpen(
+    TEXT("Labyrinth.SetWallOpen"),
+    TEXT("Open (1) or close (0) a wall slot on every labyrinth the local world has authority on"),
+    FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+    {
+        if (!World || Args.Num() < 1)
+        {
+            return;
+        }
+
+        const TArray<int32> WallIndices = { FCString::Atoi(*Args[0]) };
+        const bool bOpen = Args.Num() < 2 || FCString::Atoi(*Args[1]) != 0;
+
+        for (TActorIterator<ACircularGrid> It(World); It; ++It)
+        {
+            if (It->HasAuthority())
+            {
+                It->SetWallsOpen(WallIndices, bOpen);
+            }
+        }
+    }));
+
 
 ACircularGrid::ACircularGrid()
 {
@@ -12,19 +44,57 @@ ACircularGrid::ACircularGrid()
 
     CircularWalls = CreateDefaultSubobject<UHierarchicalInstancedStaticMeshComponent>(TEXT("CircularWalls"));
     Pillars = CreateDefaultSubobject<UHierarchicalInstancedStaticMeshComponent>(TEXT("Pillars"));
-    Path = CreateDefaultSubobject<UHierarchicalInstancedStaticMeshComponent>(TEXT("Path"));
+    Path = CreateDefaultSubobject<UInstancedStaticMeshComponent>(TEXT("Path"));
+    PathStack = CreateDefaultSubobject<UInstancedStaticMeshComponent>(TEXT("PathStack"));
+    PathStack->SetCollisionEnabled(ECollisionEnabled::NoCollision);
 
     RootComponent = CreateDefaultSubobject<USceneComponent>(TEXT("Root"));
+
+    // clients rebuild the labyrinth from the replicated state, nothing moves afterward
+    bReplicates = true;
+    bAlwaysRelevant = true;
+    NetUpdateFrequency = 1.0f;
 }
 
 void ACircularGrid::BeginPlay()
 {
     Super::BeginPlay();
 
-    SetLabyrinthEntrance(StartPath); // setup start cell algo
-    SetLabyrinthExit(EndPath); // setup end cell algo
-    StartRecursiveBacktracking(); // start algo
-    
+    RestoreRuntimeState();
+
+    // only the authority runs the generation, clients wait for the replicated state
+    if (HasAuthority())
+    {
+        NetState.Params = MakeGenerationParams();
+        ULabyrinthNetRelay::AddToPlayers(GetWorld());
+
+        if (Generator.IsFinished())
+        {
+            bNetStateDirty = true; // baked, nothing to generate
+        }
+        else
+        {
+            StartRecursiveBacktracking(); // start algo
+        }
+    }
+}
+
+void ACircularGrid::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+    Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+    // sent once per connection, later changes go through MulticastApplyWallDeltas
+    DOREPLIFETIME_CONDITION(ACircularGrid, NetState, COND_InitialOnly);
+}
+
+void ACircularGrid::PreReplication(IRepChangedPropertyTracker& ChangedPropertyTracker)
+{
+    if (bNetStateDirty)
+    {
+        RefreshNetState();
+    }
+
+    Super::PreReplication(ChangedPropertyTracker);
 }
 
 void ACircularGrid::OnConstruction(const FTransform& Transform)
@@ -32,237 +102,995 @@ void ACircularGrid::OnConstruction(const FTransform& Transform)
     Super::OnConstruction(Transform);
     ClearVariables(); // Clear Instanced text component
     GenerateGrid(); // generate grid only init cells
+
+    // bake only when the params changed since the last bake
+    if (bBakeLabyrinth && !LoadBakedLabyrinth())
+    {
+        BakeGeneration();
+        LoadBakedLabyrinth();
+    }
+
     GenerateGeometry(); // generate walls & pillars
 }
 
-
-
-void ACircularGrid::GenerateGrid()
+#if WITH_EDITOR
+void ACircularGrid::PreSave(FObjectPreSaveContext ObjectSaveContext)
+{
+    Super::PreSave(ObjectSaveContext);
+
+    // cooked levels must never regenerate a baked labyrinth, refresh a stale bake before it gets saved.
+    // Only the data, components aren't touched while saving & the geometry follows on the next construction or load.
+    if (bBakeLabyrinth && !IsTemplate() && (BakedParams != MakeGenerationParams() || BakedWalls.IsEmpty()))
+    {
+        BakeGeneration();
+    }
+}
+#endif
+
+void ACircularGrid::BakeLabyrinth()
+{
+    Modify();
+    bBakeLabyrinth = true;
+
+    ClearVariables();
+    GenerateGrid();
+    BakeGeneration();
+    LoadBakedLabyrinth();
+    GenerateGeometry();
+}
+
+void ACircularGrid::FindSeeds()
+{
+    FLabyrinthSeedSearchSettings Settings;
+    Settings.Params = MakeGenerationParams();
+    Settings.NumSeeds = NumSearchedSeeds;
+    Settings.Targets = SeedSearchTargets;
+
+    const double StartTime = FPlatformTime::Seconds();
+    TArray<FLabyrinthSeedSearchResult> Results;
+    SearchLabyrinthSeeds(Settings, Results);
+
+    UE_LOG(LogCircularGrid, Display, TEXT("%s: %d matching seeds found in %.2fs"), *GetName(), Results.Num(), FPlatformTime::Seconds() - StartTime);
+
+    Modify();
+    FoundSeeds = MoveTemp(Results);
+    if (FoundSeeds.IsEmpty())
+    {
+        return;
+    }
+
+    Seed.Initialize(FoundSeeds[0].Seed);
+
+    ClearVariables();
+    GenerateGrid();
+    if (bBakeLabyrinth)
+    {
+        BakeGeneration();
+        LoadBakedLabyrinth();
+    }
+    GenerateGeometry();
+}
+
+void ACircularGrid::BakeGeneration()
+{
+    // run the whole generation headless and keep the final walls, on its own layout so the actor state isn't needed
+    FLabyrinthLayout BakeLayout;
+    BakeLayout.Init(MaxRings, SubdivisionFactor);
+
+    FLabyrinthGenerator BakeGenerator;
+    BakeGenerator.Begin(BakeLayout, MakeGenerationParams());
+    BakeGenerator.Run();
+
+    FLabyrinthGenerator::PackWalls(BakeGenerator.Walls, BakedWalls);
+    BakedParams = BakeGenerator.GetParams();
+    BakedEntranceCell = BakeGenerator.EntranceCell;
+    BakedExitCell = BakeGenerator.ExitCell;
+}
+
+bool ACircularGrid::LoadBakedLabyrinth()
+{
+    TBitArray<> Walls;
+    if (BakedParams != MakeGenerationParams() || !FLabyrinthGenerator::UnpackWalls(BakedWalls, Layout.GetNumWalls(), Walls))
+    {
+        return false;
+    }
+
+    Generator.Load(Layout, BakedParams, Walls, BakedEntranceCell, BakedExitCell);
+
+    for (FLabyrinthCell& Cell : Cells)
+    {
+        Cell.bVisited = true;
+    }
+    return true;
+}
+
+
+
+void ACircularGrid::GenerateGrid()
+{
+    Layout.Init(MaxRings, SubdivisionFactor); // setup rings, cell indices & neighbors
+
+    Cells.Empty(); // clear cells
+    Cells.Reserve(Layout.GetNumCells());
+
+    // Setup grid cells with index, sector, ring & cell location, center cell first
+    for (int32 CellIndex = 0; CellIndex < Layout.GetNumCells(); CellIndex++)
+    {
+        FLabyrinthCell NewCell;
+        NewCell.Index = CellIndex; // cell index
+        NewCell.Ring = Layout.GetCellRing(CellIndex); // cell current ring
+        NewCell.Sector = Layout.GetCellSector(CellIndex); // cell current sector
+        NewCell.bCurrent = false;
+        NewCell.bVisited = false;
+
+        NewCell.Location = CalculateCellLocation(NewCell.Ring, NewCell.Sector); // cell location
+
+        const TConstArrayView<int32> Neighbors = Layout.GetNeighbors(CellIndex);
+        NewCell.Neighbors.Append(Neighbors.GetData(), Neighbors.Num()); // setup cells neighbors
+
+        AddDebugTextRenderer(NewCell.Location, FString::FromInt(NewCell.Index)); // add debug index cell text component
+
+        Cells.Add(NewCell); // add the new cell
+    }
+
+    // every wall is standing until the generation runs, nothing is left from a previous symmetric or baked labyrinth
+    Generator.Reset(Layout);
+    NumAppliedOpenedWalls = 0;
+
+    bLayoutReady = true;
+}
+
+void ACircularGrid::RestoreRuntimeState()
+{
+    // layout & wall instance mapping aren't serialized, rebuild them for actors loaded with their level
+    if (bLayoutReady)
+    {
+        return;
+    }
+
+    Layout.Init(MaxRings, SubdivisionFactor);
+
+    if (!bBakeLabyrinth || !LoadBakedLabyrinth())
+    {
+        Generator.Reset(Layout);
+    }
+
+    RestoreWallInstances();
+
+    bLayoutReady = true;
+}
+
+void ACircularGrid::RestoreWallInstances()
+{
+    // saved instances follow the wall order, only the mapping has to be rebuilt
+    if (CircularWalls->GetInstanceCount() != Generator.Walls.CountSetBits() || WallInstancesChecksum != FLabyrinthGenerator::GetWallsChecksum(Generator.Walls))
+    {
+        BuildWallGeometry();
+        return;
+    }
+
+    WallInstances.Init(INDEX_NONE, Layout.GetNumWalls());
+    InstanceWalls.Reset();
+    NumAppliedOpenedWalls = Generator.OpenedWalls.Num();
+
+    for (TConstSetBitIterator<> It(Generator.Walls); It; ++It)
+    {
+        WallInstances[It.GetIndex()] = InstanceWalls.Add(It.GetIndex());
+    }
+}
+
+void ACircularGrid::GenerateGeometry()
+{
+    //Remove pillar instances
+    Pillars->ClearInstances();
+    Pillars->SetCanEverAffectNavigation(bWallsAffectNavigation);
+
+    TArray<FTransform> PillarTransforms;
+
+    for(int32 Ring = 0; Ring < Layout.GetMaxRings(); Ring++) // Loop the number of time there are rings
+    {
+        const int32 CurrentSubdivisions = GetRingSubdivision(Ring + 1);
+        const float Radius = BaseRadius + Ring * RingSpacing;
+
+        // Generate pillars
+        for(int32 Sector = 0; Sector < CurrentSubdivisions; Sector++)
+        {
+            const float PillarAngle = Sector * 360.0f / CurrentSubdivisions;
+            const FVector LocationPillar = PolarToCartesian(Radius, PillarAngle) + this->GetActorLocation();
+
+            PillarTransforms.Add(FTransform(FRotator(0.0f, PillarAngle, 0.0f), LocationPillar, FVector(0.2f, 0.2f, 1.2f)));
+        }
+    }
+
+    Pillars->AddInstances(PillarTransforms, false);
+
+    BuildWallGeometry(); // generate radial & circular walls
+}
+
+FTransform ACircularGrid::GetWallTransform(int32 WallIndex) const
+{
+    const FVector MeshSize = CircularWalls->GetStaticMesh()->GetBoundingBox().GetSize();
+
+    // Radial walls, on the left edge of their cell
+    if (Layout.IsRadialWall(WallIndex))
+    {
+        const int32 CellIndex = Layout.GetWallCell(WallIndex);
+        const int32 Ring = Layout.GetCellRing(CellIndex);
+        const float Radius = BaseRadius + (Ring - 1) * RingSpacing;
+        const float Angle = Layout.GetCellSector(CellIndex) * 360.0f / GetRingSubdivision(Ring);
+
+        const FVector StartInner = PolarToCartesian(Radius, Angle);
+        const FVector EndOuter = PolarToCartesian(Radius + RingSpacing, Angle);
+
+        const FVector Direction = (EndOuter - StartInner).GetSafeNormal();
+        const float WallLength = (EndOuter - StartInner).Size();
+
+        FTransform RadialTransform;
+        RadialTransform.SetLocation((StartInner + EndOuter) * 0.5f + this->GetActorLocation());
+        RadialTransform.SetRotation(Direction.Rotation().Quaternion());
+        RadialTransform.SetScale3D(FVector(WallLength / MeshSize.Y, 1.0f, 1.0f));
+        return RadialTransform;
+    }
+
+    // Circular walls, inner wall of their cell or perimeter segment
+    int32 Circle;
+    int32 Sector;
+    int32 Subdivisions;
+    if (Layout.IsPerimeterWall(WallIndex))
+    {
+        Circle = Layout.GetOuterRing();
+        Sector = WallIndex - Layout.GetPerimeterWall(0);
+        Subdivisions = Layout.GetNumPerimeterWalls();
+    }
+    else
+    {
+        const int32 CellIndex = Layout.GetWallCell(WallIndex);
+        Circle = Layout.GetCellRing(CellIndex) - 1;
+        Sector = Layout.GetCellSector(CellIndex);
+        Subdivisions = GetRingSubdivision(Circle + 1);
+    }
+
+    const float Radius = BaseRadius + Circle * RingSpacing;
+    const float EffectiveAngleStep = 360.0f / Subdivisions;
+    const float CircularWallAngle = (Sector + 0.5f) * EffectiveAngleStep;
+
+    const float ChordLength = 2 * Radius * FMath::Sin(FMath::DegreesToRadians(EffectiveAngleStep / 2));
+    const float Scale = ChordLength / (MeshSize.X * 2);
+
+    FTransform Transform(FRotator(0.0f, CircularWallAngle + 90.0f, 0.0f), PolarToCartesian(Radius, CircularWallAngle) + this->GetActorLocation());
+    Transform.SetScale3D(FVector(Scale * 2.0f, 1.0f, 1.0f));
+    return Transform;
+}
+
+void ACircularGrid::BuildWallGeometry()
+{
+    CircularWalls->ClearInstances();
+    CircularWalls->SetCollisionEnabled(bWallCollision ? ECollisionEnabled::QueryAndPhysics : ECollisionEnabled::NoCollision);
+    CircularWalls->SetCanEverAffectNavigation(bWallsAffectNavigation);
+
+    WallInstances.Init(INDEX_NONE, Layout.GetNumWalls());
+    InstanceWalls.Reset();
+    NumAppliedOpenedWalls = Generator.OpenedWalls.Num();
+    WallInstancesChecksum = FLabyrinthGenerator::GetWallsChecksum(Generator.Walls);
+
+    if (!CircularWalls->GetStaticMesh())
+    {
+        return;
+    }
+
+    // one instance per standing wall, added in a single batch
+    TArray<FTransform> WallTransforms;
+    if (Generator.GetNumWedges() > 1)
+    {
+        BuildSymmetricWallGeometry(WallTransforms);
+    }
+    else
+    {
+        for (TConstSetBitIterator<> It(Generator.Walls); It; ++It)
+        {
+            WallInstances[It.GetIndex()] = InstanceWalls.Add(It.GetIndex());
+            WallTransforms.Add(GetWallTransform(It.GetIndex()));
+        }
+    }
+
+    CircularWalls->AddInstances(WallTransforms, false);
+}
+
+void ACircularGrid::BuildSymmetricWallGeometry(TArray<FTransform>& OutTransforms)
+{
+    const int32 NumWedges = Generator.GetNumWedges();
+    const FVector ActorLocation = this->GetActorLocation();
+
+    TArray<FQuat, TInlineAllocator<16>> WedgeRotations;
+    for (int32 Wedge = 0; Wedge < NumWedges; Wedge++)
+    {
+        WedgeRotations.Add(FQuat(FVector::UpVector, Wedge * UE_DOUBLE_TWO_PI / NumWedges));
+    }
+
+    // transforms are computed for the first wedge only & turned around the center for the others,
+    // instances are then added in wall order like the non symmetric labyrinths so saved instances map back the same way
+    TArray<FTransform> WedgeTransforms;
+    auto AddWedgeWall = [&](int32 WallIndex)
+    {
+        const FTransform WallTransform = GetWallTransform(WallIndex);
+        const FVector LocalLocation = WallTransform.GetLocation() - ActorLocation;
+
+        for (int32 Wedge = 0; Wedge < NumWedges; Wedge++)
+        {
+            // seams, center & perimeter openings can differ from one wedge to the other
+            const int32 RotatedWall = Layout.GetRotatedWall(WallIndex, Wedge, NumWedges);
+            if (!Generator.Walls[RotatedWall])
+            {
+                continue;
+            }
+
+            const FQuat& Rotation = WedgeRotations[Wedge];
+            WallInstances[RotatedWall] = WedgeTransforms.Emplace(Rotation * WallTransform.GetRotation(), ActorLocation + Rotation.RotateVector(LocalLocation), WallTransform.GetScale3D());
+        }
+    };
+
+    for (int32 Ring = 1; Ring < Layout.GetMaxRings(); Ring++)
+    {
+        const int32 WedgeSectors = GetRingSubdivision(Ring) / NumWedges;
+        for (int32 Sector = 0; Sector < WedgeSectors; Sector++)
+        {
+            const int32 CellIndex = Layout.GetCellIndex(Ring, Sector);
+            AddWedgeWall(Layout.GetInnerWall(CellIndex));
+            AddWedgeWall(Layout.GetRadialWall(CellIndex));
+        }
+    }
+
+    for (int32 Segment = 0; Segment < Layout.GetNumPerimeterWalls() / NumWedges; Segment++)
+    {
+        AddWedgeWall(Layout.GetPerimeterWall(Segment));
+    }
+
+    // WallInstances holds the wedge order index until here
+    OutTransforms.Reserve(WedgeTransforms.Num());
+    for (TConstSetBitIterator<> It(Generator.Walls); It; ++It)
+    {
+        const int32 WedgeInstance = WallInstances[It.GetIndex()];
+        WallInstances[It.GetIndex()] = InstanceWalls.Add(It.GetIndex());
+        OutTransforms.Add(WedgeTransforms[WedgeInstance]);
+    }
+}
+
+void ACircularGrid::AddWallInstance(int32 WallIndex)
+{
+    if (!WallInstances.IsValidIndex(WallIndex) || WallInstances[WallIndex] != INDEX_NONE || !CircularWalls->GetStaticMesh())
+    {
+        return;
+    }
+
+    WallInstances[WallIndex] = CircularWalls->AddInstance(GetWallTransform(WallIndex));
+    InstanceWalls.Add(WallIndex);
+}
+
+void ACircularGrid::RemoveWallInstance(int32 WallIndex)
+{
+    if (!WallInstances.IsValidIndex(WallIndex) || WallInstances[WallIndex] == INDEX_NONE)
+    {
+        return;
+    }
+
+    const int32 InstanceIndex = WallInstances[WallIndex];
+    CircularWalls->RemoveInstance(InstanceIndex);
+
+    // HISM removes with RemoveAtSwap, the last instance takes the freed slot
+    const int32 MovedWall = InstanceWalls.Pop(EAllowShrinking::No);
+    if (MovedWall != WallIndex)
+    {
+        InstanceWalls[InstanceIndex] = MovedWall;
+        WallInstances[MovedWall] = InstanceIndex;
+    }
+    WallInstances[WallIndex] = INDEX_NONE;
+}
+
+void ACircularGrid::ApplyOpenedWalls()
+{
+    // remove the instances of the walls the generator opened since last time
+    for (; NumAppliedOpenedWalls < Generator.OpenedWalls.Num(); NumAppliedOpenedWalls++)
+    {
+        RemoveWallInstance(Generator.OpenedWalls[NumAppliedOpenedWalls]);
+    }
+}
+
+void ACircularGrid::SetWallState(int32 WallIndex, bool bOpen)
+{
+    Generator.Walls[WallIndex] = !bOpen;
+
+    if (bOpen)
+    {
+        RemoveWallInstance(WallIndex);
+    }
+    else
+    {
+        AddWallInstance(WallIndex);
+    }
+}
+
+void ACircularGrid::ClearVariables()
+{
+    for (UTextRenderComponent* TextComponent : InstancedTextRenderComponents)
+    {
+        TextComponent->DestroyComponent(); // Clear Instanced text component
+    }
+    InstancedTextRenderComponents.Empty();
+}
+
+int32 ACircularGrid::GetRingSubdivision(int32 Ring) const
+{
+    return Layout.GetRingSubdivision(Ring); // formula to get subdivision at a ring && with a subdivision factor
+}
+
+int32 ACircularGrid::GetCellIndex(int32 Ring, int32 Sector)
+{
+    return Layout.GetCellIndex(Ring, Sector); // Return the cell index at a ring & sector given
+}
+
+void ACircularGrid::TestCellNeighbors(int32 index)
+{
+    for(int32 Neighbors : Cells[index].Neighbors)
+    {
+        FString DebugMessage = FString::Printf(TEXT("Selected Neighbor Index: %d"), Neighbors);
+        GEngine->AddOnScreenDebugMessage(-1, 5.f, FColor::Green, DebugMessage); // debug funct to check neighbors index of a cell
+    }
+    
+}
+
+int32 ACircularGrid::GetWallBetween(int32 CellIndex1, int32 CellIndex2) const
+{
+    if (!Cells.IsValidIndex(CellIndex1) || !Cells.IsValidIndex(CellIndex2) || !Cells[CellIndex1].Neighbors.Contains(CellIndex2))
+    {
+        return INDEX_NONE;
+    }
+
+    return Layout.GetWallBetween(CellIndex1, CellIndex2);
+}
+
+bool ACircularGrid::IsWallOpen(int32 WallIndex) const
+{
+    return Generator.Walls.IsValidIndex(WallIndex) && !Generator.Walls[WallIndex];
+}
+
+bool ACircularGrid::GetCellAtLocation(FVector WorldLocation, FLabyrinthCellCoord& OutCell) const
+{
+    const FVector LocalLocation = WorldLocation - this->GetActorLocation();
+    return GetCellAtLocalPoint(FVector2D(LocalLocation.X, LocalLocation.Y), OutCell);
+}
+
+bool ACircularGrid::DoesSegmentCrossWall(FVector Start, FVector End, int32& OutWallIndex) const
+{
+    const FVector LocalStart = Start - this->GetActorLocation();
+    const FVector LocalEnd = End - this->GetActorLocation();
+    double HitTime;
+    return FindWallOnLocalSegment(FVector2D(LocalStart.X, LocalStart.Y), FVector2D(LocalEnd.X, LocalEnd.Y), OutWallIndex, HitTime);
+}
+
+bool ACircularGrid::RaycastWalls(const FVector& Start, const FVector& End, FVector& OutHitLocation) const
+{
+    const FVector LocalStart = Start - this->GetActorLocation();
+    const FVector LocalEnd = End - this->GetActorLocation();
+
+    int32 WallIndex;
+    double HitTime;
+    const bool bHit = FindWallOnLocalSegment(FVector2D(LocalStart.X, LocalStart.Y), FVector2D(LocalEnd.X, LocalEnd.Y), WallIndex, HitTime);
+    OutHitLocation = FMath::Lerp(Start, End, HitTime);
+    return bHit;
+}
+
+void ACircularGrid::BatchSegmentsCrossWall(const TArray<FVector>& Starts, const TArray<FVector>& Ends, TArray<bool>& OutHits) const
+{
+    const int32 NumSegments = FMath::Min(Starts.Num(), Ends.Num());
+    OutHits.SetNumUninitialized(NumSegments);
+
+    // queries only read the walls, large batches are spread over the task graph
+    const FVector ActorLocation = this->GetActorLocation();
+    ParallelFor(NumSegments, [this, &Starts, &Ends, &OutHits, &ActorLocation](int32 SegmentIndex)
+    {
+        const FVector LocalStart = Starts[SegmentIndex] - ActorLocation;
+        const FVector LocalEnd = Ends[SegmentIndex] - ActorLocation;
+
+        int32 WallIndex;
+        double HitTime;
+        OutHits[SegmentIndex] = FindWallOnLocalSegment(FVector2D(LocalStart.X, LocalStart.Y), FVector2D(LocalEnd.X, LocalEnd.Y), WallIndex, HitTime);
+    }, NumSegments < 256 ? EParallelForFlags::ForceSingleThread : EParallelForFlags::None);
+}
+
+bool ACircularGrid::GetMetrics(FLabyrinthMetrics& OutMetrics) const
+{
+    if (!bLayoutReady || !Generator.IsFinished())
+    {
+        return false;
+    }
+
+    FLabyrinthMetricsCalculator Calculator;
+    Calculator.Compute(Generator, OutMetrics);
+    return true;
+}
+
+FVector ACircularGrid::GetCellWorldLocation(int32 CellIndex) const
+{
+    return Cells.IsValidIndex(CellIndex) ? Cells[CellIndex].Location + this->GetActorLocation() : this->GetActorLocation();
+}
+
+FVector ACircularGrid::ClampToCell(const FVector& WorldLocation, int32 CellIndex) const
+{
+    if (!Cells.IsValidIndex(CellIndex))
+    {
+        return WorldLocation;
+    }
+
+    const FVector ActorLocation = this->GetActorLocation();
+    const FVector2D LocalPoint(WorldLocation - ActorLocation);
+    const double Radius = LocalPoint.Size();
+
+    // a tenth of the ring spacing away from the walls
+    const double Margin = RingSpacing * 0.1;
+
+    FVector2D ClampedPoint = LocalPoint;
+    const int32 Ring = Layout.GetCellRing(CellIndex);
+    if (Ring == 0)
+    {
+        const double MaxRadius = FMath::Max(BaseRadius - Margin, 0.0);
+        if (Radius > MaxRadius)
+        {
+            ClampedPoint = LocalPoint * (MaxRadius / Radius);
+        }
+    }
+    else
+    {
+        const double InnerRadius = BaseRadius + (Ring - 1) * RingSpacing;
+        const double ClampedRadius = FMath::Clamp(Radius, InnerRadius + Margin, InnerRadius + RingSpacing - Margin);
+
+        // same angle convention as GetCellAtLocalPoint, the angle is taken from the start of the sector
+        const double SectorAngle = UE_DOUBLE_TWO_PI / GetRingSubdivision(Ring);
+        const double StartAngle = Layout.GetCellSector(CellIndex) * SectorAngle;
+        double Angle = FMath::Fmod(FMath::Atan2(LocalPoint.Y, LocalPoint.X) - StartAngle + 2.0 * UE_DOUBLE_TWO_PI, UE_DOUBLE_TWO_PI);
+
+        // outside of the sector snaps to the closest side
+        if (Angle > SectorAngle)
+        {
+            Angle = Angle - SectorAngle < UE_DOUBLE_TWO_PI - Angle ? SectorAngle : 0.0;
+        }
+
+        const double AngleMargin = FMath::Min(Margin / ClampedRadius, SectorAngle / 3.0);
+        Angle = StartAngle + FMath::Clamp(Angle, AngleMargin, SectorAngle - AngleMargin);
+        ClampedPoint = FVector2D(ClampedRadius * FMath::Cos(Angle), ClampedRadius * FMath::Sin(Angle));
+    }
+
+    return FVector(ClampedPoint.X, ClampedPoint.Y, Cells[CellIndex].Location.Z) + ActorLocation;
+}
+
+bool ACircularGrid::FindCellPath(int32 StartCell, int32 EndCell, TArray<int32>& OutCells) const
+{
+    OutCells.Reset();
+
+    const int32 NumCells = Layout.GetNumCells();
+    if (!bLayoutReady || Cells.Num() != NumCells || Generator.Walls.Num() != Layout.GetNumWalls()
+        || StartCell < 0 || StartCell >= NumCells || EndCell < 0 || EndCell >= NumCells)
+    {
+        return false;
+    }
+
+    struct FOpenCell
+    {
+        double Estimate;
+        double Cost;
+        int32 CellIndex;
+    };
+    auto IsCloser = [](const FOpenCell& Left, const FOpenCell& Right) { return Left.Estimate < Right.Estimate; };
+
+    TArray<double> Costs;
+    Costs.Init(TNumericLimits<double>::Max(), NumCells);
+    TArray<int32> Parents;
+    Parents.Init(INDEX_NONE, NumCells);
+
+    const FVector EndLocation = Cells[EndCell].Location;
+    TArray<FOpenCell> OpenCells;
+    Costs[StartCell] = 0.0;
+    Parents[StartCell] = StartCell;
+    OpenCells.HeapPush({ FVector::Dist2D(Cells[StartCell].Location, EndLocation), 0.0, StartCell }, IsCloser);
+
+    while (OpenCells.Num() > 0)
+    {
+        FOpenCell OpenCell;
+        OpenCells.HeapPop(OpenCell, IsCloser, EAllowShrinking::No);
+        if (OpenCell.CellIndex == EndCell)
+        {
+            break;
+        }
+
+        // a cheaper way to this cell was pushed after this one
+        if (OpenCell.Cost > Costs[OpenCell.CellIndex])
+        {
+            continue;
+        }
+
+        const TConstArrayView<int32> Neighbors = Layout.GetNeighbors(OpenCell.CellIndex);
+        for (int32 NeighborSlot = 0; NeighborSlot < Neighbors.Num(); NeighborSlot++)
+        {
+            const int32 Neighbor = Neighbors[NeighborSlot];
+            if (Neighbor == OpenCell.CellIndex || Generator.Walls[Layout.GetNeighborWall(OpenCell.CellIndex, NeighborSlot)])
+            {
+                continue;
+            }
+
+            const double Cost = OpenCell.Cost + FVector::Dist2D(Cells[OpenCell.CellIndex].Location, Cells[Neighbor].Location);
+            if (Cost < Costs[Neighbor])
+            {
+                Costs[Neighbor] = Cost;
+                Parents[Neighbor] = OpenCell.CellIndex;
+                OpenCells.HeapPush({ Cost + FVector::Dist2D(Cells[Neighbor].Location, EndLocation), Cost, Neighbor }, IsCloser);
+            }
+        }
+    }
+
+    if (Parents[EndCell] == INDEX_NONE)
+    {
+        return false;
+    }
+
+    for (int32 CellIndex = EndCell; ; CellIndex = Parents[CellIndex])
+    {
+        OutCells.Add(CellIndex);
+        if (CellIndex == StartCell)
+        {
+            break;
+        }
+    }
+    Algo::Reverse(OutCells);
+    return true;
+}
+
+bool ACircularGrid::FindNearestPerimeterOpening(const FVector2D& LocalPoint, int32& OutCellIndex, int32& OutSegment) const
+{
+    OutCellIndex = INDEX_NONE;
+    OutSegment = INDEX_NONE;
+
+    const int32 NumSegments = Layout.GetNumPerimeterWalls();
+    const double OuterRadius = GetOuterRadius();
+    double BestDistance = TNumericLimits<double>::Max();
+
+    for (int32 Segment = 0; Segment < NumSegments; Segment++)
+    {
+        if (Generator.Walls[Layout.GetPerimeterWall(Segment)])
+        {
+            continue;
+        }
+
+        const double Angle = (Segment + 0.5) * UE_DOUBLE_TWO_PI / NumSegments;
+        const double Distance = FVector2D::DistSquared(LocalPoint, FVector2D(OuterRadius * FMath::Cos(Angle), OuterRadius * FMath::Sin(Angle)));
+        if (Distance < BestDistance)
+        {
+            BestDistance = Distance;
+            OutSegment = Segment;
+        }
+    }
+
+    if (OutSegment == INDEX_NONE)
+    {
+        return false;
+    }
+
+    const int32 OuterRing = Layout.GetOuterRing();
+    OutCellIndex = Layout.GetCellIndex(OuterRing, OutSegment * GetRingSubdivision(OuterRing) / NumSegments);
+    return true;
+}
+
+bool ACircularGrid::FindPathPoints(FVector Start, FVector End, TArray<FVector>& OutPoints) const
+{
+    OutPoints.Reset();
+
+    FLabyrinthCellCoord StartCoord;
+    FLabyrinthCellCoord EndCoord;
+    const bool bStartInside = GetCellAtLocation(Start, StartCoord);
+    const bool bEndInside = GetCellAtLocation(End, EndCoord);
+    if (!bStartInside && !bEndInside)
+    {
+        return false;
+    }
+
+    // always walk from the end inside the labyrinth, a path coming in is reversed at the end
+    const bool bReversed = !bStartInside;
+    const FVector InsidePoint = bReversed ? End : Start;
+    const FVector OtherPoint = bReversed ? Start : End;
+    const FVector2D LocalInside(InsidePoint - this->GetActorLocation());
+    const FVector2D LocalOther(OtherPoint - this->GetActorLocation());
+
+    int32 TargetCell = EndCoord.Index;
+    int32 ExitSegment = INDEX_NONE;
+    if (!(bStartInside && bEndInside) && !FindNearestPerimeterOpening(LocalOther, TargetCell, ExitSegment))
+    {
+        return false;
+    }
+
+    TArray<int32> CellPath;
+    if (!FindCellPath((bReversed ? EndCoord : StartCoord).Index, TargetCell, CellPath))
+    {
+        return false;
+    }
+
+    auto GetPoint = [](double Radius, double Angle) { return FVector2D(Radius * FMath::Cos(Angle), Radius * FMath::Sin(Angle)); };
+    auto GetSectorAngle = [this](int32 CellIndex) { return UE_DOUBLE_TWO_PI / GetRingSubdivision(Layout.GetCellRing(CellIndex)); };
+    auto GetCellStartAngle = [this, &GetSectorAngle](int32 CellIndex) { return Layout.GetCellSector(CellIndex) * GetSectorAngle(CellIndex); };
+
+    // angles are kept in the range of their cell so the path never wraps through the cell's own left wall
+    auto GetCellAngle = [&GetCellStartAngle](int32 CellIndex, double Angle)
+    {
+        const double StartAngle = GetCellStartAngle(CellIndex);
+        return StartAngle + FMath::Fmod(Angle - StartAngle + 2.0 * UE_DOUBLE_TWO_PI, UE_DOUBLE_TWO_PI);
+    };
+
+    TArray<FVector2D> LocalPoints;
+    auto AddPoint = [&LocalPoints](const FVector2D& Point)
+    {
+        if (LocalPoints.IsEmpty() || !LocalPoints.Last().Equals(Point, 1.0))
+        {
+            LocalPoints.Add(Point);
+        }
+    };
+
+    // follow the middle of the ring, in steps short enough that no chord cuts through the inner circle
+    auto AddArc = [this, &AddPoint, &GetPoint](int32 CellIndex, double FromAngle, double ToAngle)
+    {
+        const int32 Ring = Layout.GetCellRing(CellIndex);
+        if (Ring == 0)
+        {
+            AddPoint(FVector2D::ZeroVector);
+            return;
+        }
+
+        const double MidRadius = BaseRadius + (Ring - 0.5) * RingSpacing;
+        const double MaxStep = FMath::Max(FMath::Acos((MidRadius - RingSpacing * 0.5) / MidRadius), 0.05);
+        const int32 NumSteps = FMath::Max(1, FMath::CeilToInt32(FMath::Abs(ToAngle - FromAngle) / MaxStep));
+        for (int32 Step = 1; Step <= NumSteps; Step++)
+        {
+            AddPoint(GetPoint(MidRadius, FMath::Lerp(FromAngle, ToAngle, static_cast<double>(Step) / NumSteps)));
+        }
+    };
+
+    int32 CellIndex = CellPath[0];
+    double Angle = GetCellAngle(CellIndex, FMath::Atan2(LocalInside.Y, LocalInside.X));
+    AddPoint(LocalInside);
+    AddArc(CellIndex, Angle, Angle);
+
+    for (int32 PathIndex = 1; PathIndex < CellPath.Num(); PathIndex++)
+    {
+        const int32 NextCell = CellPath[PathIndex];
+
+        if (Layout.GetCellRing(NextCell) != Layout.GetCellRing(CellIndex))
+        {
+            // straight across the middle of the inner wall of the outer cell
+            const int32 OuterCell = Layout.GetCellRing(NextCell) > Layout.GetCellRing(CellIndex) ? NextCell : CellIndex;
+            const double WallAngle = GetCellStartAngle(OuterCell) + GetSectorAngle(OuterCell) * 0.5;
+
+            AddArc(CellIndex, Angle, GetCellAngle(CellIndex, WallAngle));
+            Angle = GetCellAngle(NextCell, WallAngle);
+            AddArc(NextCell, Angle, Angle);
+        }
+        else
+        {
+            // through the radial wall, on the left edge of the cell owning it. On a ring of two sectors both edges lead to the next cell.
+            const bool bThroughLeftEdge = Layout.GetNeighbors(CellIndex)[0] == NextCell && !Generator.Walls[Layout.GetNeighborWall(CellIndex, 0)];
+            const int32 OwnerCell = bThroughLeftEdge ? CellIndex : NextCell;
+
+            AddArc(CellIndex, Angle, GetCellStartAngle(CellIndex) + (OwnerCell == CellIndex ? 0.0 : GetSectorAngle(CellIndex)));
+            Angle = GetCellStartAngle(NextCell) + (OwnerCell == NextCell ? 0.0 : GetSectorAngle(NextCell));
+        }
+
+        CellIndex = NextCell;
+    }
+
+    if (ExitSegment == INDEX_NONE)
+    {
+        AddArc(CellIndex, Angle, GetCellAngle(CellIndex, FMath::Atan2(LocalOther.Y, LocalOther.X)));
+    }
+    else
+    {
+        // out through the middle of the perimeter opening
+        const double ExitAngle = (ExitSegment + 0.5) * UE_DOUBLE_TWO_PI / Layout.GetNumPerimeterWalls();
+        AddArc(CellIndex, Angle, GetCellAngle(CellIndex, ExitAngle));
+        AddPoint(GetPoint(GetOuterRadius() + RingSpacing * 0.5, ExitAngle));
+    }
+    AddPoint(LocalOther);
+
+    // intermediate points stay at the height of the inside end
+    OutPoints.Reserve(LocalPoints.Num());
+    for (const FVector2D& LocalPoint : LocalPoints)
+    {
+        OutPoints.Emplace(this->GetActorLocation().X + LocalPoint.X, this->GetActorLocation().Y + LocalPoint.Y, InsidePoint.Z);
+    }
+    OutPoints[0] = InsidePoint;
+    OutPoints.Last() = OtherPoint;
+
+    if (bReversed)
+    {
+        Algo::Reverse(OutPoints);
+    }
+    return true;
+}
+
+void ACircularGrid::PostRegisterAllComponents()
+{
+    Super::PostRegisterAllComponents();
+
+    if (UWorld* World = GetWorld())
+    {
+        for (TActorIterator<ALabyrinthNavData> It(World); It; ++It)
+        {
+            It->RegisterLabyrinth(this);
+        }
+    }
+}
+
+void ACircularGrid::PostUnregisterAllComponents()
+{
+    if (UWorld* World = GetWorld())
+    {
+        for (TActorIterator<ALabyrinthNavData> It(World); It; ++It)
+        {
+            It->UnregisterLabyrinth(this);
+        }
+    }
+
+    Super::PostUnregisterAllComponents();
+}
+
+void ACircularGrid::InvalidateNavigationPaths() const
+{
+    // paths found through the cell graph before a wall change get a repath
+    for (TActorIterator<ALabyrinthNavData> It(GetWorld()); It; ++It)
+    {
+        It->InvalidateActivePaths();
+    }
+}
+
+bool ACircularGrid::GetCellAtLocalPoint(const FVector2D& LocalPoint, FLabyrinthCellCoord& OutCell) const
 {
-    Cells.Empty(); // clear cells
-    
-    int32 CellIndex = 0;
-
-    // Create and store center cell
-    FLabyrinthCell CenterCell;                     
-    CenterCell.Index = CellIndex++; // Increment to next index cell
-    CenterCell.Ring = 0;                            
-    CenterCell.Sector = 0;
-    CenterCell.bCurrent = false;
-    CenterCell.bVisited = false;
-    Cells.Add(CenterCell);
-    
-    AddDebugTextRenderer(FVector::Zero(), FString::FromInt(CenterCell.Index)); // add debug index cell text component
-    
-    
+    const double Radius = LocalPoint.Size();
 
-    // Setup grid cells with index, sector, ring & cell location
-    for(int32 Ring = 1; Ring < MaxRings; Ring++)
+    // center cell
+    if (Radius < BaseRadius)
     {
-        const int32 CurrentSubdivisions = GetRingSubdivision(Ring); // store current ring subdivision
+        OutCell = FLabyrinthCellCoord();
+        return Layout.GetNumCells() > 0;
+    }
 
-        for(int32 Sector = 0; Sector < CurrentSubdivisions; Sector++)
-        {
-            FLabyrinthCell NewCell;
-            NewCell.Index = CellIndex++; // cell index
-            NewCell.Ring = Ring; // cell current ring 
-            NewCell.Sector = Sector; // cell current sector
-            
-            NewCell.Location = CalculateCellLocation(NewCell.Ring, NewCell.Sector); // cell location
-            
-            AddDebugTextRenderer(NewCell.Location,  FString::FromInt(NewCell.Index)); // add debug index cell text component
-            
-            Cells.Add(NewCell); // add the new cell 
-        }
+    const int32 Ring = FMath::FloorToInt32((Radius - BaseRadius) / RingSpacing) + 1;
+    if (Ring >= Layout.GetMaxRings())
+    {
+        return false;
     }
 
-    for(FLabyrinthCell& Cell : Cells)
+    // same angle convention as PolarToCartesian
+    double Angle = FMath::Atan2(LocalPoint.Y, LocalPoint.X);
+    if (Angle < 0.0)
     {
-        CalculateCellNeighbors(Cell); // setup cells neighbors
+        Angle += UE_DOUBLE_TWO_PI;
     }
+
+    const int32 Subdivisions = GetRingSubdivision(Ring);
+    OutCell.Ring = Ring;
+    OutCell.Sector = FMath::Min(FMath::FloorToInt32(Angle / UE_DOUBLE_TWO_PI * Subdivisions), Subdivisions - 1);
+    OutCell.Index = Layout.GetCellIndex(Ring, OutCell.Sector);
+    return true;
 }
 
-void ACircularGrid::GenerateGeometry()
+bool ACircularGrid::FindWallOnLocalSegment(const FVector2D& Start, const FVector2D& End, int32& OutWallIndex, double& OutHitTime) const
 {
-    //Remove pillar, radial walls & circular walls instances
-    CircularWalls->ClearInstances();
-    Pillars->ClearInstances();
-    
-    const int32 MaxSubdivisions = GetRingSubdivision(MaxRings); // Store max subdivision of labyrinth
-    const float BaseAngleStep = 360.0f / MaxSubdivisions; // Angle steps in degrees
-    
-    for(int32 Ring = 0; Ring < MaxRings; Ring++) // Loop the number of time there are rings
+    OutWallIndex = INDEX_NONE;
+    OutHitTime = 1.0;
+
+    const FVector2D Direction = End - Start;
+    const double A = Direction.SizeSquared();
+    if (A <= UE_DOUBLE_SMALL_NUMBER || Generator.Walls.Num() != Layout.GetNumWalls())
     {
-        const int32 CurrentSubdivisions = FMath::Pow(2.0f, FMath::FloorLog2(Ring + 1) + SubdivisionFactor);
-        const int32 SubdivisionRatio = MaxSubdivisions / CurrentSubdivisions;
-        const float Radius = BaseRadius + Ring * RingSpacing;
-        const float EffectiveAngleStep = 360.0f / CurrentSubdivisions;
+        return false;
+    }
 
-        // Generate Circular walls & pillars
-        for(int32 Sector = 0; Sector < CurrentSubdivisions; Sector++)
+    auto GetAngle = [](const FVector2D& Point)
+    {
+        const double Angle = FMath::Atan2(Point.Y, Point.X);
+        return Angle < 0.0 ? Angle + UE_DOUBLE_TWO_PI : Angle;
+    };
+
+    // Segment parameters where it crosses a circle of walls, sorted along the segment
+    TArray<TPair<double, int32>, TInlineAllocator<32>> Crossings;
+    const double B = Start | Direction;
+    for (int32 Circle = 0; Circle < Layout.GetMaxRings(); Circle++)
+    {
+        const double Radius = BaseRadius + Circle * RingSpacing;
+        const double Discriminant = B * B - A * (Start.SizeSquared() - Radius * Radius);
+        if (Discriminant <= 0.0)
         {
-            float CircularWallAngle = ((Sector + 0.5f) * SubdivisionRatio * BaseAngleStep);
-            float PillarAngle = (Sector * SubdivisionRatio * BaseAngleStep);
-
-            const FVector LocationCircularWall = PolarToCartesian(Radius, CircularWallAngle);
-            const FVector LocationPillar = PolarToCartesian(Radius, PillarAngle) + this->GetActorLocation();
-            const FRotator Rotation(0.0f, CircularWallAngle + 90.0f, 0.0f);
-            
-            const float ChordLength = 2 * Radius * FMath::Sin(FMath::DegreesToRadians(EffectiveAngleStep / 2));
-            const float Scale = ChordLength / (CircularWalls->GetStaticMesh()->GetBoundingBox().GetSize().X * 2);
-            
-            FTransform Transform(Rotation, LocationCircularWall + this->GetActorLocation());
-            Transform.SetScale3D(FVector(Scale * 2.0f, 1.0f, 1.0f));
-            CircularWalls->AddInstance(Transform);
-            Pillars->AddInstance(FTransform(FRotator(0.0f, PillarAngle, 0.0f), LocationPillar, FVector(0.2f, 0.2f, 1.2f)));
-
+            continue;
         }
 
-        // Generate radial walls
-        if(Ring < MaxRings - 1)
+        const double Root = FMath::Sqrt(Discriminant);
+        for (const double T : { (-B - Root) / A, (-B + Root) / A })
         {
-            const float NextRadius = Radius + RingSpacing;
-
-            for(int32 Sector = 0; Sector < CurrentSubdivisions; Sector++)
+            if (T > 0.0 && T < 1.0)
             {
-                
-                const float CurrentAngle = Sector * SubdivisionRatio * BaseAngleStep;
-                const float NextAngle = CurrentAngle;
-
-                
-                const FVector StartInner = PolarToCartesian(Radius, CurrentAngle);
-                const FVector EndOuter = PolarToCartesian(NextRadius, NextAngle);
-
-                
-                const FVector Direction = (EndOuter - StartInner).GetSafeNormal();
-                const float WallLength = (EndOuter - StartInner).Size();
-                const FVector RadialMeshSize = CircularWalls->GetStaticMesh()->GetBoundingBox().GetSize();
-                
-                FTransform RadialTransform;
-                RadialTransform.SetLocation((StartInner + EndOuter) * 0.5f + this->GetActorLocation());
-                RadialTransform.SetRotation(Direction.Rotation().Quaternion());
-                RadialTransform.SetScale3D(FVector(WallLength / RadialMeshSize.Y, 1.0f, 1.0f));
-                
-                CircularWalls->AddInstance(RadialTransform);
+                Crossings.Emplace(T, Circle);
             }
         }
     }
-}
+    Crossings.Sort([](const TPair<double, int32>& Left, const TPair<double, int32>& Right) { return Left.Key < Right.Key; });
+    Crossings.Emplace(1.0, INDEX_NONE);
 
-void ACircularGrid::CalculateCellNeighbors(FLabyrinthCell& Cell)
-{
-    Cell.Neighbors.Empty(); // Clear cell neighbors
+    // the angle along a line always turns the same way
+    const double TurnSign = FVector2D::CrossProduct(Start, Direction) >= 0.0 ? 1.0 : -1.0;
 
-    if (Cell.Index == 0 && Cell.Ring == 0 && Cell.Sector == 0) // Check if is center cell
-    {
-        for (int i = 0; i < FMath::Pow(2.0f, FMath::FloorLog2(1) + SubdivisionFactor); i++)
-        {
-            Cell.Neighbors.Add(i + 1);  // Setup center cell neighbors
-        }
-    }
-    else
+    double PieceStart = 0.0;
+    for (const TPair<double, int32>& Crossing : Crossings)
     {
-        const int32 Ring = Cell.Ring;
-        const int32 Sector = Cell.Sector;
-    
-        // Setup right & left cell neighbors
-        int32 CurrentSubdivisions = FMath::Pow(2.0f, FMath::FloorLog2(Ring) + SubdivisionFactor);
-        const int32 LeftSector = (Sector - 1 + CurrentSubdivisions) % CurrentSubdivisions;
-        const int32 RightSector = (Sector + 1) % CurrentSubdivisions;
-    
-        Cell.Neighbors.Add(GetCellIndex(Ring, LeftSector));
-        Cell.Neighbors.Add(GetCellIndex(Ring, RightSector));
+        // Radial walls crossed between two circles
+        const FVector2D PieceStartPoint = Start + Direction * PieceStart;
+        const FVector2D PieceEndPoint = Start + Direction * Crossing.Key;
+        const double MidRadius = (Start + Direction * ((PieceStart + Crossing.Key) * 0.5)).Size();
+        const int32 Ring = MidRadius < BaseRadius ? 0 : FMath::FloorToInt32((MidRadius - BaseRadius) / RingSpacing) + 1;
 
-        // Setup cell parent neighbors
-        if(Ring == 1)
-        {
-            Cell.Neighbors.Add(0); 
-        }
-        else if(Ring > 1)
+        if (Ring > 0 && Ring < Layout.GetMaxRings())
         {
-            CurrentSubdivisions = FMath::Pow(2.0f, FMath::FloorLog2(Ring) + SubdivisionFactor);
-        
-            if (CurrentSubdivisions >  FMath::Pow(2.0f, FMath::FloorLog2(Ring - 1) + SubdivisionFactor))
+            const int32 Subdivisions = GetRingSubdivision(Ring);
+            const double SectorAngle = UE_DOUBLE_TWO_PI / Subdivisions;
+            const double StartAngle = GetAngle(PieceStartPoint);
+            const double SweptAngle = FMath::Abs(FMath::Atan2(FVector2D::CrossProduct(PieceStartPoint, PieceEndPoint), PieceStartPoint | PieceEndPoint));
+            const double EndAngle = StartAngle + TurnSign * SweptAngle;
+
+            const int32 StartBoundary = FMath::FloorToInt32(StartAngle / SectorAngle);
+            const int32 EndBoundary = FMath::FloorToInt32(EndAngle / SectorAngle);
+            const int32 Step = EndBoundary >= StartBoundary ? 1 : -1;
+
+            // boundary k is the left edge of sector k, crossed going either way
+            for (int32 Boundary = StartBoundary + (Step > 0 ? 1 : 0); Boundary != EndBoundary + (Step > 0 ? 1 : 0); Boundary += Step)
             {
-                Cell.Neighbors.Add(GetCellIndex(Ring - 1, floor(Sector / 2)));
-            }
-            else
-            {
-                Cell.Neighbors.Add(GetCellIndex(Ring - 1, Sector));
+                const int32 Sector = ((Boundary % Subdivisions) + Subdivisions) % Subdivisions;
+                const int32 WallIndex = Layout.GetRadialWall(Layout.GetCellIndex(Ring, Sector));
+                if (Generator.Walls[WallIndex])
+                {
+                    // where the segment meets the line carrying the boundary
+                    const FVector2D BoundaryDirection(FMath::Cos(Boundary * SectorAngle), FMath::Sin(Boundary * SectorAngle));
+                    const double Denominator = FVector2D::CrossProduct(BoundaryDirection, Direction);
+                    OutHitTime = FMath::Abs(Denominator) > UE_DOUBLE_SMALL_NUMBER ? FMath::Clamp(-FVector2D::CrossProduct(BoundaryDirection, Start) / Denominator, 0.0, 1.0) : PieceStart;
+                    OutWallIndex = WallIndex;
+                    return true;
+                }
             }
         }
 
-        // Setup cell children neighbors
-        if(Ring < MaxRings - 1)
+        if (Crossing.Value == INDEX_NONE)
         {
-            CurrentSubdivisions = FMath::Pow(2.0f, FMath::FloorLog2(Ring) + SubdivisionFactor);
-        
-            if (CurrentSubdivisions <  FMath::Pow(2.0f, FMath::FloorLog2(Ring + 1) + SubdivisionFactor))
-            {
-                Cell.Neighbors.Add(GetCellIndex(Ring + 1, Sector * 2));
-                Cell.Neighbors.Add(GetCellIndex(Ring + 1, Sector * 2 + 1));
-            }
-            else
-            {
-                Cell.Neighbors.Add(GetCellIndex(Ring + 1, Sector));
-            }
-            
+            break;
         }
-    }
-    
-}
-
-void ACircularGrid::ClearVariables()
-{
-    for (UTextRenderComponent* TextComponent : InstancedTextRenderComponents)
-    {
-        TextComponent->DestroyComponent(); // Clear Instanced text component
-    }
-    InstancedTextRenderComponents.Empty();
-}
 
-int32 ACircularGrid::GetCurrentCell()
-{
-    for (FLabyrinthCell Cell : Cells)
-    {
-        if (Cell.bCurrent)
+        // Circular wall at the crossing
+        const double CrossingAngle = GetAngle(PieceEndPoint);
+        int32 WallIndex;
+        if (Crossing.Value == Layout.GetOuterRing())
         {
-            return Cell.Index; // loop through all cells and return the current one
+            const int32 Segment = FMath::Min(FMath::FloorToInt32(CrossingAngle / UE_DOUBLE_TWO_PI * Layout.GetNumPerimeterWalls()), Layout.GetNumPerimeterWalls() - 1);
+            WallIndex = Layout.GetPerimeterWall(Segment);
+        }
+        else
+        {
+            const int32 Subdivisions = GetRingSubdivision(Crossing.Value + 1);
+            const int32 Sector = FMath::Min(FMath::FloorToInt32(CrossingAngle / UE_DOUBLE_TWO_PI * Subdivisions), Subdivisions - 1);
+            WallIndex = Layout.GetInnerWall(Layout.GetCellIndex(Crossing.Value + 1, Sector));
         }
-    }
-
-    return 0;
-}
-
-int32 ACircularGrid::GetRingSubdivision(int32 Ring)
-{
-    return FMath::Pow(2.0f, FMath::FloorLog2(Ring) + SubdivisionFactor); // formula to get subdivision at a ring && with a subdivision factor
-}
 
-int32 ACircularGrid::GetCellIndex(int32 Ring, int32 Sector)
-{
-    if(Ring == 0) return 0; // center cell
+        if (Generator.Walls[WallIndex])
+        {
+            OutHitTime = Crossing.Key;
+            OutWallIndex = WallIndex;
+            return true;
+        }
 
-    int32 Index = 1; 
-    
-    for(int32 r = 1; r < Ring; r++)
-    {
-        const int32 Subdivisions = FMath::Pow(2.0f, FMath::FloorLog2(r) + SubdivisionFactor);
-        Index += Subdivisions;
+        PieceStart = Crossing.Key;
     }
-    
-    const int32 CurrentSubdivisions = FMath::Pow(2.0f, FMath::FloorLog2(Ring) + SubdivisionFactor);
-    return Index + (Sector % CurrentSubdivisions); // Return the cell index at a ring & sector given
-}
 
-void ACircularGrid::TestCellNeighbors(int32 index)
-{
-    for(int32 Neighbors : Cells[index].Neighbors)
-    {
-        FString DebugMessage = FString::Printf(TEXT("Selected Neighbor Index: %d"), Neighbors);
-        GEngine->AddOnScreenDebugMessage(-1, 5.f, FColor::Green, DebugMessage); // debug funct to check neighbors index of a cell
-    }
-    
+    return false;
 }
 
 FVector ACircularGrid::PolarToCartesian(float Radius, float Angle) const
@@ -282,7 +1110,7 @@ FVector ACircularGrid::CalculateCellLocation(int32 Ring, int32 Sector) const
     // do the same logic same as grid point but with offset (*0.5) to get the center of the cell
     const float MiddleRadius = BaseRadius + ((Ring - 1) * RingSpacing) + (RingSpacing * 0.5f);
     
-    const int32 Subdivisions = FMath::Pow(2.0f, FMath::FloorLog2(Ring) + SubdivisionFactor);
+    const int32 Subdivisions = GetRingSubdivision(Ring);
     const float AngleStep = 360.0f / Subdivisions;
     const float MidAngle = (Sector + 0.5f) * AngleStep;
 
@@ -318,130 +1146,87 @@ void ACircularGrid::AddDebugTextRenderer(FVector TextLoc, FString TextMessage)
     }
 }
 
-void ACircularGrid::SetLabyrinthEntrance(ELabyrinthStart ELabyrinthEntrance)
+void ACircularGrid::UpdatePathLocalisation(FLabyrinthCell Cell)
 {
-    int32 PerimeterCellChosen;
-    FLabyrinthCell& FirstCell = Cells[0];
+    // move debug cube to show the path when the algorithm run, the same instance is moved every step
     
-    switch (ELabyrinthEntrance)
-    {
-        // Set center cell current & visited 
-    case ELabyrinthStart::Center:
-        
-        FirstCell.bCurrent = true;
-        FirstCell.bVisited = true;
-        
-        break;
-        
-        // Set a random perimeter cell current & visited
-    case ELabyrinthStart::Perimeter:
-
-        PerimeterCellChosen = GetRandomPerimeterCell();
-        FLabyrinthCell& RandomCell = Cells[PerimeterCellChosen];
-        
-        RandomCell.bCurrent = true;
-        RandomCell.bVisited = true;
+    FTransform MakeTransform;
+    MakeTransform.SetLocation(Cell.Location + this->GetActorLocation());
+    MakeTransform.SetRotation(FQuat(FRotator::ZeroRotator));
+    MakeTransform.SetScale3D(FVector(1, 1, 1));
 
-        OpenPerimeterCell(Cells[PerimeterCellChosen]);
-        
-        break;
-        
+    if (Path->GetInstanceCount() == 0)
+    {
+        Path->AddInstance(MakeTransform, true);
+    }
+    else
+    {
+        Path->UpdateInstanceTransform(0, MakeTransform, true, true, true);
     }
 }
 
-void ACircularGrid::SetLabyrinthExit(ELabyrinthExit ELabyrinthExit)
+void ACircularGrid::UpdatePathStack(int32 NumBacktracked)
 {
-    FLabyrinthCell& EndCell = Cells[0];
-
-    // set center cell visited
-    switch (ELabyrinthExit)
+    if (!bShowBacktrackingStack)
     {
-    case ELabyrinthExit::Center:
-
-        EndCell.bCurrent = false;
-        EndCell.bVisited = true;
-        
-        break;
+        return;
     }
-}
 
-int32 ACircularGrid::GetRandomPerimeterCell()
-{
-    TArray<int32> PossibleIndex;
+    // the bottom of the stack never moves, only the popped cells & the new top are touched
+    const TArray<int32>& StackCells = Generator.PathStack;
+    const int32 NumInstances = PathStack->GetInstanceCount();
+    const int32 FirstChanged = FMath::Clamp(NumInstances - NumBacktracked, 0, StackCells.Num());
+    const int32 NumReused = FMath::Max(FMath::Min(NumInstances, StackCells.Num()) - FirstChanged, 0);
 
-    // return a random perimeter cell
-    for (FLabyrinthCell& Cell : Cells)
+    TArray<FTransform> ReusedTransforms;
+    TArray<FTransform> AddedTransforms;
+    for (int32 StackIndex = FirstChanged; StackIndex < StackCells.Num(); StackIndex++)
     {
-        if (Cell.Ring == MaxRings - 1)
-        {
-            PossibleIndex.Add(Cell.Index);
-        }
+        const FTransform StackTransform(FRotator::ZeroRotator, Cells[StackCells[StackIndex]].Location + this->GetActorLocation(), FVector(0.5f));
+        (StackIndex < FirstChanged + NumReused ? ReusedTransforms : AddedTransforms).Add(StackTransform);
     }
 
-    
-    return PossibleIndex[Seed.RandRange(0, FMath::Clamp(PossibleIndex.Num() - 1, 0, PossibleIndex.Num() - 1))];
-}
+    // pop from the end so no instance gets swapped
+    for (int32 InstanceIndex = NumInstances - 1; InstanceIndex >= StackCells.Num(); InstanceIndex--)
+    {
+        PathStack->RemoveInstance(InstanceIndex);
+    }
 
-void ACircularGrid::RemoveWall(FLabyrinthCell Cell1, FLabyrinthCell Cell2)
-{
-    FHitResult HitResult;
-    TArray<AActor*> ActorsToIgnore;
-    
-    // Cast a line between two cell and remove the wall between
-    
-    UKismetSystemLibrary::LineTraceSingle(
-        GetWorld(),
-        Cell1.Location + this->GetActorLocation(),
-        Cell2.Location + this->GetActorLocation(),
-        UEngineTypes::ConvertToTraceType(ECC_Visibility), 
-        false,
-        ActorsToIgnore,
-        EDrawDebugTrace::None,
-        HitResult,
-        true
-    );
+    if (ReusedTransforms.Num() > 0)
+    {
+        PathStack->BatchUpdateInstancesTransforms(FirstChanged, ReusedTransforms, true, true, true);
+    }
 
-    CircularWalls->RemoveInstance(HitResult.Item);
+    if (AddedTransforms.Num() > 0)
+    {
+        PathStack->AddInstances(AddedTransforms, false, true);
+    }
 }
 
-void ACircularGrid::OpenPerimeterCell(FLabyrinthCell Cell)
+void ACircularGrid::StartRecursiveBacktracking()
 {
-    FHitResult HitResult;
-    TArray<AActor*> ActorsToIgnore;
-
-    // remove wall of a perimeter cell
-    
-    UKismetSystemLibrary::LineTraceSingle(
-        GetWorld(),
-        Cell.Location + this->GetActorLocation(),
-        (((Cell.Location + this->GetActorLocation()) - this->GetActorLocation()).GetSafeNormal()) *  RingSpacing + Cell.Location + this->GetActorLocation(),
-        UEngineTypes::ConvertToTraceType(ECC_Visibility),
-        false,
-        ActorsToIgnore,
-        EDrawDebugTrace::None,
-        HitResult,
-        true
-        );
-
-    CircularWalls->RemoveInstance(HitResult.Item);
-}
+    // setup start & end cells, opens the entrance wall
+    Generator.Begin(Layout, MakeGenerationParams());
+    ApplyOpenedWalls();
 
-void ACircularGrid::UpdatePathLocalisation(FLabyrinthCell Cell)
-{
+    // the stack never holds more than every cell, instances are only pushed & popped at its end
     Path->ClearInstances();
+    PathStack->ClearInstances();
+    if (bShowBacktrackingStack)
+    {
+        if (!PathStack->GetStaticMesh())
+        {
+            PathStack->SetStaticMesh(Path->GetStaticMesh());
+        }
+        PathStack->PreAllocateInstancesMemory(Layout.GetNumCells());
+    }
 
-    // move debug cube to show the path when the algorithm run
-    
-    FTransform MakeTransform;
-    MakeTransform.SetLocation(Cell.Location + this->GetActorLocation());
-    MakeTransform.SetRotation(FQuat(FRotator::ZeroRotator));
-    MakeTransform.SetScale3D(FVector(1, 1, 1));
-    
-    Path->AddInstance(MakeTransform, true);
-}
+    if (EndPath == ELabyrinthExit::Center)
+    {
+        UpdateCurrentVisitedState(0, false, true);
+    }
+    UpdateCurrentVisitedState(Generator.CurrentCell, true, true);
 
-void ACircularGrid::StartRecursiveBacktracking()
-{
     // funct to apply delay between recursive algo
     if (AnimationDelay <= 0)
     {
@@ -452,147 +1237,244 @@ void ACircularGrid::StartRecursiveBacktracking()
 
 void ACircularGrid::RecursiveBacktrackingStep()
 {
-    // Open labyrinth exit wall when algo finished
-    if (RecursiveBacktrackingFinished)
+    const int32 PreviousCell = Generator.CurrentCell;
+
+    FLabyrinthGenerationStep GenerationStep;
+    Generator.Step(GenerationStep);
+
+    // Update current cell & move the path, the generator opens the exit wall once finished
+    UpdateCurrentVisitedState(PreviousCell, false, true);
+    UpdateCurrentVisitedState(Generator.CurrentCell, !Generator.IsFinished(), true);
+    UpdatePathLocalisation(Cells[GenerationStep.PathCell]);
+    UpdatePathStack(GenerationStep.NumBacktracked);
+    ApplyOpenedWalls();
+
+    if (Generator.IsFinished())
     {
         GetWorld()->GetTimerManager().ClearTimer(TimerHandleBacktracking);
+        RecursiveBacktrackingFinished = true;
+        bNetStateDirty = true;
+        InvalidateNavigationPaths();
+    }
+}
 
-        switch (EndPath)
-        {
-        case ELabyrinthExit::Center:
-            OpenCenterCell(LongestPathCell);
-            break;
+void ACircularGrid::UpdateCurrentVisitedState(int32 CellIndex, bool Current, bool Visited)
+{
+    // Update the specified cell his current & visited state
+    FLabyrinthCell& UpdatedCell = Cells[CellIndex];
+    UpdatedCell.bCurrent = Current;
+    UpdatedCell.bVisited = Visited;
+}
 
-        case ELabyrinthExit::Farest:
-            OpenPerimeterCell(LongestPathCell);
-            break;
+void ACircularGrid::SetWallsOpen(const TArray<int32>& WallIndices, bool bOpen)
+{
+    if (!HasAuthority() || !Generator.IsFinished())
+    {
+        return;
+    }
 
-        case ELabyrinthExit::RandomPerimeter:
-            OpenPerimeterCell(Cells[GetRandomPerimeterCell()]);
-            break;
-            
+    FLabyrinthWallDeltas Deltas;
+    for (const int32 WallIndex : WallIndices)
+    {
+        if (Generator.Walls.IsValidIndex(WallIndex) && Generator.Walls[WallIndex] == bOpen)
+        {
+            SetWallState(WallIndex, bOpen);
+            Deltas.Add(WallIndex, bOpen);
         }
     }
 
-    CurrentPathCell = Cells[GetCurrentCell()];
-    
-    ProgressPath();
-   
-    
+    if (Deltas.PackedWalls.IsEmpty())
+    {
+        return;
+    }
+
+    // joining clients can't regenerate these walls from the params anymore
+    bWallsEditedAtRuntime = true;
+    bNetStateDirty = true;
+
+    Deltas.PackedWalls.Sort();
+    MulticastApplyWallDeltas(Deltas);
+    InvalidateNavigationPaths();
 }
 
-void ACircularGrid::ProgressPath()
+void ACircularGrid::MulticastApplyWallDeltas_Implementation(const FLabyrinthWallDeltas& Deltas)
 {
-    FLabyrinthCell ChosenNeighbor;
-    if (GetPotentialNextNeighbor(CurrentPathCell, ChosenNeighbor)) // Check potential current cell neighbors
+    // already applied on the authority
+    if (HasAuthority())
     {
-        // Neighbors found & update current cell to progress path
-        
-        NextPathCell = ChosenNeighbor;
-        UpdatePathLocalisation(NextPathCell);
-        RemoveWall(CurrentPathCell, NextPathCell);
-        UpdateCurrentVisitedState(CurrentPathCell.Index, false, true);
-        UpdateCurrentVisitedState(NextPathCell.Index, true, true);
-        PathStackCells.Add(Cells[CurrentPathCell.Index]);
-
-        // Update the longest path
-        switch (EndPath)
-        {
-        case ELabyrinthExit::Center:
-            FoundLongestPathAtRing(1);
-            break;
-
-        case ELabyrinthExit::Farest:
-            FoundLongestPathAtRing(MaxRings - 1);
-            break;
-
-        case ELabyrinthExit::RandomPerimeter:
-            break;
-        }
-        
+        return;
     }
-    else
+
+    for (const uint32 PackedWall : Deltas.PackedWalls)
     {
-        // No neighbors found start backtracking 
-        UpdateCurrentVisitedState(CurrentPathCell.Index, false, true);
-        UpdatePathLocalisation(CurrentPathCell);
-        if (!PathStackCells.IsEmpty())
-        {
-            CurrentPathCell = PathStackCells[PathStackCells.Num() - 1];
-            UpdateCurrentVisitedState(CurrentPathCell.Index, true, true);
-            UpdateCurrentVisitedState(NextPathCell.Index, false, true);
-            PathStackCells.RemoveAt(PathStackCells.Num() - 1);
-            ProgressPath();
-        }
-        else
+        const int32 WallIndex = FLabyrinthWallDeltas::GetWallIndex(PackedWall);
+        if (Generator.Walls.IsValidIndex(WallIndex))
         {
-            RecursiveBacktrackingFinished = true;
+            SetWallState(WallIndex, FLabyrinthWallDeltas::IsOpen(PackedWall));
         }
     }
 }
 
-bool ACircularGrid::GetPotentialNextNeighbor(FLabyrinthCell Cell, FLabyrinthCell& ChosenNeighbors)
+FLabyrinthGenerationParams ACircularGrid::MakeGenerationParams() const
+{
+    FLabyrinthGenerationParams Params;
+    Params.MaxRings = MaxRings;
+    Params.SubdivisionFactor = SubdivisionFactor;
+    Params.Seed = Seed.GetInitialSeed();
+    Params.StartPath = StartPath;
+    Params.EndPath = EndPath;
+    Params.SymmetryFold = FMath::Max(SymmetryFold, 1);
+    Params.SymmetrySeamOpenings = FMath::Max(SymmetrySeamOpenings, 1);
+    return Params;
+}
+
+void ACircularGrid::ApplyGenerationParams(const FLabyrinthGenerationParams& Params)
+{
+    MaxRings = Params.MaxRings;
+    SubdivisionFactor = Params.SubdivisionFactor;
+    Seed.Initialize(Params.Seed);
+    StartPath = Params.StartPath;
+    EndPath = Params.EndPath;
+    SymmetryFold = Params.SymmetryFold;
+    SymmetrySeamOpenings = Params.SymmetrySeamOpenings;
+}
+
+void ACircularGrid::RefreshNetState()
 {
-    TArray<FLabyrinthCell> PotentialNeighbors;
-    TArray<int32> NeighborIndices;
+    bNetStateDirty = false;
 
-    // Get all potential cell neighbors in a list and return a random cell of this list
-    for (int32 Index : Cells[Cell.Index].Neighbors)
+    if ((bWallsEditedAtRuntime || bAlwaysReplicateWalls) && MakeWallsNetState(NetState))
     {
-        if (!Cells[Index].bVisited)
-        {
-            PotentialNeighbors.Add(Cells[Index]);
-            NeighborIndices.Add(Index);
-        }
+        return;
     }
-    
-   if (PotentialNeighbors.IsEmpty())
+
+    // clients regenerate from the params
+    NetState = FLabyrinthNetState();
+    NetState.Params = MakeGenerationParams();
+    NetState.WallsChecksum = Generator.IsFinished() ? FLabyrinthGenerator::GetWallsChecksum(Generator.Walls) : 0;
+}
+
+bool ACircularGrid::MakeWallsNetState(FLabyrinthNetState& OutState) const
+{
+    if (!Generator.IsFinished())
     {
         return false;
     }
-    
-    int32 rndIndex = Seed.RandRange(0, FMath::Clamp(PotentialNeighbors.Num() - 1, 0, PotentialNeighbors.Num() - 1));
-    ChosenNeighbors = PotentialNeighbors[rndIndex];
-    
-    return !PotentialNeighbors.IsEmpty();
-    
+
+    OutState.Params = MakeGenerationParams();
+    OutState.WallsChecksum = FLabyrinthGenerator::GetWallsChecksum(Generator.Walls);
+    OutState.EntranceCell = Generator.EntranceCell;
+    OutState.ExitCell = Generator.ExitCell;
+
+    TArray<uint8> WallBytes;
+    FLabyrinthGenerator::PackWalls(Generator.Walls, WallBytes);
+
+    int32 CompressedSize = FCompression::CompressMemoryBound(NAME_Zlib, WallBytes.Num());
+    OutState.CompressedWalls.SetNumUninitialized(CompressedSize);
+
+    if (FCompression::CompressMemory(NAME_Zlib, OutState.CompressedWalls.GetData(), CompressedSize, WallBytes.GetData(), WallBytes.Num())
+        && CompressedSize < WallBytes.Num())
+    {
+        OutState.CompressedWalls.SetNum(CompressedSize);
+        OutState.UncompressedSize = WallBytes.Num();
+    }
+    else
+    {
+        OutState.CompressedWalls = MoveTemp(WallBytes); // stored raw when compression doesn't help
+        OutState.UncompressedSize = 0;
+    }
+    return true;
 }
 
-void ACircularGrid::UpdateCurrentVisitedState(int32 CellIndex, bool Current, bool Visited)
+void ACircularGrid::RequestAuthorityWalls()
 {
-    // Update the specified cell his current & visited state
-    FLabyrinthCell& UpdatedCell = Cells[CellIndex];
-    UpdatedCell.bCurrent = Current;
-    UpdatedCell.bVisited = Visited;
+    // a relay that didn't replicate yet sends the request from its BeginPlay
+    bWaitingForAuthorityWalls = true;
+    if (ULabyrinthNetRelay* Relay = ULabyrinthNetRelay::FindLocal(GetWorld()))
+    {
+        Relay->ServerRequestWalls(this);
+    }
 }
 
-void ACircularGrid::FoundLongestPathAtRing(int32 Ring)
+void ACircularGrid::ReceiveAuthorityWalls(const FLabyrinthNetState& State)
 {
-    //override the longest registered path by the new one
-    if (PathStackCells.Num() - 1  > LongestPath && Ring == NextPathCell.Ring)
+    if (!bWaitingForAuthorityWalls || State.CompressedWalls.IsEmpty())
     {
-        LongestPath = PathStackCells.Num() - 1;
-        LongestPathCell = Cells[NextPathCell.Index];
+        return;
     }
+
+    bWaitingForAuthorityWalls = false;
+    NetState = State;
+    OnRep_NetState();
 }
 
-void ACircularGrid::OpenCenterCell(FLabyrinthCell Cell)
+void ACircularGrid::OnRep_NetState()
 {
-    FHitResult HitResult;
-    TArray<AActor*> ActorsToIgnore;
-    
-    // remove wall between center cell and the given input cell
-    UKismetSystemLibrary::LineTraceSingle(
-        GetWorld(),
-        Cell.Location + this->GetActorLocation(),
-        (((this->GetActorLocation() - (Cell.Location + this->GetActorLocation())).GetSafeNormal()) *  RingSpacing) + Cell.Location + this->GetActorLocation(),
-        UEngineTypes::ConvertToTraceType(ECC_Visibility),
-        false,
-        ActorsToIgnore,
-        EDrawDebugTrace::None,
-        HitResult,
-        true
-        );
-
-    CircularWalls->RemoveInstance(HitResult.Item);
+    // a loaded bake already matches the authority, nothing to rebuild
+    if (bBakeLabyrinth && bLayoutReady && Generator.IsFinished() && NetState.CompressedWalls.IsEmpty() && NetState.Params == MakeGenerationParams())
+    {
+        return;
+    }
+
+    ApplyGenerationParams(NetState.Params);
+
+    ClearVariables();
+    GenerateGrid();
+
+    if (NetState.CompressedWalls.IsEmpty())
+    {
+        // deterministic regeneration, no animation on clients. A baked labyrinth is already there.
+        if (!bBakeLabyrinth || !LoadBakedLabyrinth())
+        {
+            Generator.Begin(Layout, NetState.Params);
+            Generator.Run();
+        }
+
+        // the params can't be trusted on this client, the authority sends its walls
+        if (NetState.WallsChecksum != 0 && NetState.WallsChecksum != FLabyrinthGenerator::GetWallsChecksum(Generator.Walls))
+        {
+            UE_LOG(LogCircularGrid, Warning, TEXT("%s: regenerated walls differ from the authority, requesting them"), *GetName());
+            RequestAuthorityWalls();
+        }
+    }
+    else
+    {
+        TArray<uint8> WallBytes;
+        bool bUnpacked;
+
+        // the packed walls size is known from the layout, anything else comes from a bad packet
+        if (NetState.UncompressedSize > 0 && NetState.UncompressedSize != FMath::DivideAndRoundUp(Layout.GetNumWalls(), 8))
+        {
+            bUnpacked = false;
+        }
+        else if (NetState.UncompressedSize > 0)
+        {
+            WallBytes.SetNumUninitialized(NetState.UncompressedSize);
+            bUnpacked = FCompression::UncompressMemory(NAME_Zlib, WallBytes.GetData(), WallBytes.Num(), NetState.CompressedWalls.GetData(), NetState.CompressedWalls.Num());
+        }
+        else
+        {
+            WallBytes = NetState.CompressedWalls;
+            bUnpacked = true;
+        }
+
+        TBitArray<> Walls;
+        if (!bUnpacked || !FLabyrinthGenerator::UnpackWalls(WallBytes, Layout.GetNumWalls(), Walls))
+        {
+            UE_LOG(LogCircularGrid, Error, TEXT("%s: invalid replicated walls"), *GetName());
+            Walls.Init(true, Layout.GetNumWalls());
+        }
+
+        // out of range cells come from a bad packet, the labyrinth is still usable without them
+        const int32 EntranceCell = NetState.EntranceCell >= 0 && NetState.EntranceCell < Layout.GetNumCells() ? NetState.EntranceCell : INDEX_NONE;
+        const int32 ExitCell = NetState.ExitCell >= 0 && NetState.ExitCell < Layout.GetNumCells() ? NetState.ExitCell : INDEX_NONE;
+        Generator.Load(Layout, NetState.Params, Walls, EntranceCell, ExitCell);
+    }
+
+    for (FLabyrinthCell& Cell : Cells)
+    {
+        Cell.bVisited = true;
+    }
+
+    GenerateGeometry();
 }
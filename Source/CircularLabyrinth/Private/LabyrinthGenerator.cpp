@@ -0,0 +1,410 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "LabyrinthGenerator.h"
+
+void FLabyrinthGenerator::Begin(const FLabyrinthLayout& InLayout, const FLabyrinthGenerationParams& InParams)
+{
+    Layout = &InLayout;
+    Params = InParams;
+    Stream.Initialize(Params.Seed);
+
+    Walls.Init(true, Layout->GetNumWalls());
+    Visited.Init(false, Layout->GetNumCells());
+    OpenedWalls.Reset();
+    PathStack.Reset(Layout->GetNumCells());
+
+    CurrentCell = 0;
+    EntranceCell = INDEX_NONE;
+    ExitCell = INDEX_NONE;
+    LongestPath = -1; // a cell reached straight from the start still counts
+    LongestPathCell = INDEX_NONE;
+    bFinished = false;
+    InitWedges();
+
+    // setup start cell
+    switch (Params.StartPath)
+    {
+    case ELabyrinthStart::Center:
+        EntranceCell = 0;
+        break;
+
+    case ELabyrinthStart::Perimeter:
+        EntranceCell = GetRandomPerimeterCell();
+        OpenPerimeterCell(EntranceCell);
+        break;
+    }
+
+    // symmetric labyrinths carve the first wedge only, the center & the other wedges are joined once it's done
+    if (NumWedges > 1)
+    {
+        Visited[0] = true;
+        for (int32 Ring = 1; Ring < Layout->GetMaxRings(); Ring++)
+        {
+            const int32 Subdivisions = Layout->GetRingSubdivision(Ring);
+            Visited.SetRange(Layout->GetRingFirstCell(Ring) + Subdivisions / NumWedges, Subdivisions - Subdivisions / NumWedges, true);
+        }
+
+        const int32 OuterRing = Layout->GetOuterRing();
+        CurrentCell = Layout->GetCellIndex(OuterRing, Stream.RandRange(0, Layout->GetRingSubdivision(OuterRing) / NumWedges - 1));
+        Visited[CurrentCell] = true;
+        return;
+    }
+
+    CurrentCell = EntranceCell;
+    Visited[EntranceCell] = true;
+
+    // the center cell is kept for the exit, path never go through it
+    if (Params.EndPath == ELabyrinthExit::Center)
+    {
+        Visited[0] = true;
+    }
+}
+
+void FLabyrinthGenerator::Step(FLabyrinthGenerationStep& OutStep)
+{
+    OutStep = FLabyrinthGenerationStep();
+
+    if (bFinished)
+    {
+        OutStep.PathCell = CurrentCell;
+        return;
+    }
+
+    while (true)
+    {
+        const int32 ChosenNeighbor = GetPotentialNextNeighbor(CurrentCell);
+        if (ChosenNeighbor != INDEX_NONE)
+        {
+            // Neighbor found, carve and progress path
+            OpenCarvedWall(Layout->GetWallBetween(CurrentCell, ChosenNeighbor));
+            Visited[ChosenNeighbor] = true;
+            PathStack.Add(CurrentCell);
+            CurrentCell = ChosenNeighbor;
+
+            // Update the longest path
+            switch (Params.EndPath)
+            {
+            case ELabyrinthExit::Center:
+                FoundLongestPathAtRing(ChosenNeighbor, 1);
+                break;
+
+            case ELabyrinthExit::Farest:
+                FoundLongestPathAtRing(ChosenNeighbor, Layout->GetOuterRing());
+                break;
+
+            case ELabyrinthExit::RandomPerimeter:
+                break;
+            }
+
+            OutStep.PathCell = ChosenNeighbor;
+            OutStep.NextCell = ChosenNeighbor;
+            return;
+        }
+
+        // No neighbors found, backtrack
+        if (PathStack.IsEmpty())
+        {
+            OpenExit();
+            OutStep.PathCell = CurrentCell;
+            return;
+        }
+
+        CurrentCell = PathStack.Pop(EAllowShrinking::No);
+        OutStep.NumBacktracked++;
+    }
+}
+
+void FLabyrinthGenerator::Run()
+{
+    FLabyrinthGenerationStep GenerationStep;
+    while (!bFinished)
+    {
+        Step(GenerationStep);
+    }
+}
+
+void FLabyrinthGenerator::Load(const FLabyrinthLayout& InLayout, const FLabyrinthGenerationParams& InParams, const TBitArray<>& InWalls, int32 InEntranceCell, int32 InExitCell)
+{
+    Layout = &InLayout;
+    Params = InParams;
+
+    Walls = InWalls;
+    Visited.Init(true, Layout->GetNumCells());
+    OpenedWalls.Reset();
+    PathStack.Reset();
+
+    EntranceCell = InEntranceCell;
+    ExitCell = InExitCell;
+    CurrentCell = FMath::Max(InEntranceCell, 0);
+    bFinished = true;
+    InitWedges();
+}
+
+void FLabyrinthGenerator::Reset(const FLabyrinthLayout& InLayout)
+{
+    Layout = &InLayout;
+    Params = FLabyrinthGenerationParams();
+
+    Walls.Init(true, Layout->GetNumWalls());
+    Visited.Init(false, Layout->GetNumCells());
+    OpenedWalls.Reset();
+    PathStack.Reset();
+
+    CurrentCell = 0;
+    EntranceCell = INDEX_NONE;
+    ExitCell = INDEX_NONE;
+    LongestPathCell = INDEX_NONE;
+    NumWedges = 1;
+    bFinished = false;
+}
+
+int32 FLabyrinthGenerator::GetRandomPerimeterCell()
+{
+    const int32 OuterRing = Layout->GetOuterRing();
+    const int32 NumPerimeterCells = OuterRing == 0 ? 1 : Layout->GetRingSubdivision(OuterRing);
+
+    return Layout->GetRingFirstCell(OuterRing) + Stream.RandRange(0, NumPerimeterCells - 1);
+}
+
+int32 FLabyrinthGenerator::GetPotentialNextNeighbor(int32 CellIndex)
+{
+    TArray<int32, TInlineAllocator<8>> PotentialNeighbors;
+
+    for (const int32 Neighbor : Layout->GetNeighbors(CellIndex))
+    {
+        if (!Visited[Neighbor])
+        {
+            PotentialNeighbors.Add(Neighbor);
+        }
+    }
+
+    if (PotentialNeighbors.IsEmpty())
+    {
+        return INDEX_NONE;
+    }
+
+    return PotentialNeighbors[Stream.RandRange(0, PotentialNeighbors.Num() - 1)];
+}
+
+void FLabyrinthGenerator::OpenWall(int32 WallIndex)
+{
+    if (Walls[WallIndex])
+    {
+        Walls[WallIndex] = false;
+        OpenedWalls.Add(WallIndex);
+    }
+}
+
+void FLabyrinthGenerator::OpenPerimeterCell(int32 CellIndex)
+{
+    int32 FirstWall;
+    int32 NumWalls;
+    Layout->GetPerimeterWalls(CellIndex, FirstWall, NumWalls);
+
+    for (int32 WallIndex = FirstWall; WallIndex < FirstWall + NumWalls; WallIndex++)
+    {
+        OpenWall(WallIndex);
+    }
+}
+
+void FLabyrinthGenerator::FoundLongestPathAtRing(int32 CellIndex, int32 Ring)
+{
+    //override the longest registered path by the new one
+    if (PathStack.Num() - 1 > LongestPath && Layout->GetCellRing(CellIndex) == Ring)
+    {
+        LongestPath = PathStack.Num() - 1;
+        LongestPathCell = CellIndex;
+    }
+}
+
+void FLabyrinthGenerator::OpenExit()
+{
+    bFinished = true;
+
+    if (NumWedges > 1)
+    {
+        JoinWedges();
+        return;
+    }
+
+    switch (Params.EndPath)
+    {
+    case ELabyrinthExit::Center:
+        // a path started at the center already carved its way out, another opening would make a loop
+        if (EntranceCell == 0)
+        {
+            ExitCell = 0;
+            break;
+        }
+
+        // an entrance alone on the first ring never moves, it opens on the center itself
+        if (LongestPathCell == INDEX_NONE && Layout->GetCellRing(EntranceCell) == 1)
+        {
+            LongestPathCell = EntranceCell;
+        }
+
+        if (LongestPathCell != INDEX_NONE)
+        {
+            OpenWall(Layout->GetInnerWall(LongestPathCell));
+            ExitCell = 0;
+        }
+        break;
+
+    case ELabyrinthExit::Farest:
+        // an entrance alone on the outer ring never records a longest path, it's the exit too
+        if (LongestPathCell == INDEX_NONE && EntranceCell != INDEX_NONE && Layout->GetCellRing(EntranceCell) == Layout->GetOuterRing())
+        {
+            LongestPathCell = EntranceCell;
+        }
+
+        if (LongestPathCell != INDEX_NONE)
+        {
+            OpenPerimeterCell(LongestPathCell);
+            ExitCell = LongestPathCell;
+        }
+        break;
+
+    case ELabyrinthExit::RandomPerimeter:
+        ExitCell = GetRandomPerimeterCell();
+        OpenPerimeterCell(ExitCell);
+        break;
+    }
+}
+
+void FLabyrinthGenerator::InitWedges()
+{
+    // every ring must split evenly, the first one is the least subdivided
+    NumWedges = 1;
+    if (Layout->GetMaxRings() > 1 && Params.SymmetryFold > 1)
+    {
+        NumWedges = FMath::Min(1 << FMath::FloorLog2(Params.SymmetryFold), Layout->GetRingSubdivision(1));
+    }
+}
+
+void FLabyrinthGenerator::OpenCarvedWall(int32 WallIndex)
+{
+    if (NumWedges == 1)
+    {
+        OpenWall(WallIndex);
+        return;
+    }
+
+    // the same wall opens in every wedge
+    for (int32 Wedge = 0; Wedge < NumWedges; Wedge++)
+    {
+        OpenWall(Layout->GetRotatedWall(WallIndex, Wedge, NumWedges));
+    }
+}
+
+void FLabyrinthGenerator::JoinWedges()
+{
+    const int32 OuterRing = Layout->GetOuterRing();
+
+    // same passages on every seam but the one before the first wedge, so the wedges make a chain and no loop
+    TArray<int32, TInlineAllocator<32>> SeamRings;
+    for (int32 Ring = 1; Ring <= OuterRing; Ring++)
+    {
+        SeamRings.Add(Ring);
+    }
+
+    const int32 NumPassages = FMath::Clamp(Params.SymmetrySeamOpenings, 1, SeamRings.Num());
+    for (int32 Passage = 0; Passage < NumPassages; Passage++)
+    {
+        SeamRings.Swap(Passage, Stream.RandRange(Passage, SeamRings.Num() - 1));
+
+        // left wall of the first cell of the ring, seam before the first wedge
+        const int32 SeamWall = Layout->GetRadialWall(Layout->GetRingFirstCell(SeamRings[Passage]));
+        for (int32 Wedge = 1; Wedge < NumWedges; Wedge++)
+        {
+            OpenWall(Layout->GetRotatedWall(SeamWall, Wedge, NumWedges));
+        }
+    }
+
+    // the center joins a single first ring cell, as far as possible from a perimeter entrance when it's the exit
+    const int32 CenterNeighbor = EntranceCell != 0 && Params.EndPath == ELabyrinthExit::Center
+        ? FindFarthestCell(EntranceCell, 1)
+        : Layout->GetRingFirstCell(1) + Stream.RandRange(0, Layout->GetRingSubdivision(1) - 1);
+    OpenWall(Layout->GetInnerWall(CenterNeighbor));
+
+    // the carving never went through the whole labyrinth, the farthest exit is searched on it
+    switch (Params.EndPath)
+    {
+    case ELabyrinthExit::Center:
+        ExitCell = 0;
+        break;
+
+    case ELabyrinthExit::Farest:
+        ExitCell = FindFarthestCell(EntranceCell, OuterRing);
+        OpenPerimeterCell(ExitCell);
+        break;
+
+    case ELabyrinthExit::RandomPerimeter:
+        ExitCell = GetRandomPerimeterCell();
+        OpenPerimeterCell(ExitCell);
+        break;
+    }
+}
+
+int32 FLabyrinthGenerator::FindFarthestCell(int32 FromCell, int32 Ring)
+{
+    // breadth first over the open walls, the last cell of the ring reached is the farthest
+    SearchReached.Init(false, Layout->GetNumCells());
+    SearchQueue.Reset();
+    SearchQueue.Add(FromCell);
+    SearchReached[FromCell] = true;
+
+    int32 FarthestCell = FromCell;
+    for (int32 QueueIndex = 0; QueueIndex < SearchQueue.Num(); QueueIndex++)
+    {
+        const int32 CellIndex = SearchQueue[QueueIndex];
+        if (Layout->GetCellRing(CellIndex) == Ring)
+        {
+            FarthestCell = CellIndex;
+        }
+
+        const TConstArrayView<int32> Neighbors = Layout->GetNeighbors(CellIndex);
+        for (int32 NeighborSlot = 0; NeighborSlot < Neighbors.Num(); NeighborSlot++)
+        {
+            const int32 Neighbor = Neighbors[NeighborSlot];
+            if (Neighbor != CellIndex && !SearchReached[Neighbor] && !Walls[Layout->GetNeighborWall(CellIndex, NeighborSlot)])
+            {
+                SearchReached[Neighbor] = true;
+                SearchQueue.Add(Neighbor);
+            }
+        }
+    }
+    return FarthestCell;
+}
+
+void FLabyrinthGenerator::PackWalls(const TBitArray<>& InWalls, TArray<uint8>& OutBytes)
+{
+    OutBytes.SetNumZeroed(FMath::DivideAndRoundUp(InWalls.Num(), 8));
+
+    for (TConstSetBitIterator<> It(InWalls); It; ++It)
+    {
+        OutBytes[It.GetIndex() >> 3] |= 1 << (It.GetIndex() & 7);
+    }
+}
+
+bool FLabyrinthGenerator::UnpackWalls(const TArray<uint8>& InBytes, int32 NumWalls, TBitArray<>& OutWalls)
+{
+    if (InBytes.Num() != FMath::DivideAndRoundUp(NumWalls, 8))
+    {
+        return false;
+    }
+
+    OutWalls.Init(false, NumWalls);
+    for (int32 WallIndex = 0; WallIndex < NumWalls; WallIndex++)
+    {
+        OutWalls[WallIndex] = (InBytes[WallIndex >> 3] & (1 << (WallIndex & 7))) != 0;
+    }
+    return true;
+}
+
+uint32 FLabyrinthGenerator::GetWallsChecksum(const TBitArray<>& InWalls)
+{
+    TArray<uint8> Bytes;
+    PackWalls(InWalls, Bytes);
+    return FCrc::MemCrc32(Bytes.GetData(), Bytes.Num(), InWalls.Num());
+}
@@ -0,0 +1,177 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "LabyrinthLayout.h"
+
+void FLabyrinthLayout::Init(int32 InMaxRings, int32 InSubdivisionFactor)
+{
+    MaxRings = FMath::Max(InMaxRings, 1);
+    SubdivisionFactor = FMath::Clamp(InSubdivisionFactor, 0, 16);
+
+    // first cell index of every ring, the last entry is the number of cells
+    RingFirstCell.SetNumUninitialized(MaxRings + 1);
+    RingFirstCell[0] = 0;
+    RingFirstCell[1] = 1;
+    for (int32 Ring = 1; Ring < MaxRings; Ring++)
+    {
+        RingFirstCell[Ring + 1] = RingFirstCell[Ring] + GetRingSubdivision(Ring);
+    }
+
+    const int32 NumCells = RingFirstCell[MaxRings];
+    CellRings.SetNumUninitialized(NumCells);
+    CellRings[0] = 0;
+    for (int32 Ring = 1; Ring < MaxRings; Ring++)
+    {
+        for (int32 CellIndex = RingFirstCell[Ring]; CellIndex < RingFirstCell[Ring + 1]; CellIndex++)
+        {
+            CellRings[CellIndex] = Ring;
+        }
+    }
+
+    NeighborOffsets.SetNumUninitialized(NumCells + 1);
+    Neighbors.Reset(NumCells * 5);
+
+    // Setup center cell neighbors
+    NeighborOffsets[0] = 0;
+    for (int32 Sector = 0; MaxRings > 1 && Sector < GetRingSubdivision(1); Sector++)
+    {
+        Neighbors.Add(GetCellIndex(1, Sector));
+    }
+
+    for (int32 CellIndex = 1; CellIndex < NumCells; CellIndex++)
+    {
+        NeighborOffsets[CellIndex] = Neighbors.Num();
+
+        const int32 Ring = CellRings[CellIndex];
+        const int32 Sector = CellIndex - RingFirstCell[Ring];
+        const int32 CurrentSubdivisions = GetRingSubdivision(Ring);
+
+        // Setup right & left cell neighbors
+        Neighbors.Add(GetCellIndex(Ring, (Sector - 1 + CurrentSubdivisions) % CurrentSubdivisions));
+        Neighbors.Add(GetCellIndex(Ring, (Sector + 1) % CurrentSubdivisions));
+
+        // Setup cell parent neighbors
+        if (Ring == 1)
+        {
+            Neighbors.Add(0);
+        }
+        else
+        {
+            Neighbors.Add(GetCellIndex(Ring - 1, CurrentSubdivisions > GetRingSubdivision(Ring - 1) ? Sector / 2 : Sector));
+        }
+
+        // Setup cell children neighbors
+        if (Ring < MaxRings - 1)
+        {
+            if (CurrentSubdivisions < GetRingSubdivision(Ring + 1))
+            {
+                Neighbors.Add(GetCellIndex(Ring + 1, Sector * 2));
+                Neighbors.Add(GetCellIndex(Ring + 1, Sector * 2 + 1));
+            }
+            else
+            {
+                Neighbors.Add(GetCellIndex(Ring + 1, Sector));
+            }
+        }
+    }
+    NeighborOffsets[NumCells] = Neighbors.Num();
+}
+
+int32 FLabyrinthLayout::GetWallBetween(int32 CellA, int32 CellB) const
+{
+    const int32 RingA = CellRings[CellA];
+    const int32 RingB = CellRings[CellB];
+
+    // cells on different rings are separated by the inner wall of the outer one
+    if (RingA != RingB)
+    {
+        return GetInnerWall(RingA > RingB ? CellA : CellB);
+    }
+
+    // cells on the same ring are separated by the left radial wall of the cell on the right
+    const int32 Subdivisions = GetRingSubdivision(RingA);
+    const int32 SectorA = CellA - RingFirstCell[RingA];
+    const int32 SectorB = CellB - RingFirstCell[RingB];
+    return GetRadialWall(SectorB == (SectorA + 1) % Subdivisions ? CellB : CellA);
+}
+
+int32 FLabyrinthLayout::GetNeighborWall(int32 CellIndex, int32 NeighborSlot) const
+{
+    const int32 Neighbor = Neighbors[NeighborOffsets[CellIndex] + NeighborSlot];
+    if (CellIndex == 0)
+    {
+        return GetInnerWall(Neighbor);
+    }
+
+    // slots are left, right, parent then children
+    switch (NeighborSlot)
+    {
+    case 0:
+        return GetRadialWall(CellIndex);
+    case 1:
+        return GetRadialWall(Neighbor);
+    case 2:
+        return GetInnerWall(CellIndex);
+    default:
+        return GetInnerWall(Neighbor);
+    }
+}
+
+bool FLabyrinthLayout::GetWallCells(int32 WallIndex, int32& OutCellA, int32& OutCellB) const
+{
+    const int32 CellIndex = GetWallCell(WallIndex);
+    if (CellIndex == INDEX_NONE)
+    {
+        return false;
+    }
+
+    const int32 Ring = CellRings[CellIndex];
+    const int32 Sector = CellIndex - RingFirstCell[Ring];
+    const int32 Subdivisions = GetRingSubdivision(Ring);
+
+    OutCellA = CellIndex;
+    if (IsRadialWall(WallIndex))
+    {
+        // left neighbor
+        OutCellB = GetCellIndex(Ring, (Sector - 1 + Subdivisions) % Subdivisions);
+    }
+    else
+    {
+        // parent cell
+        OutCellB = Ring == 1 ? 0 : GetCellIndex(Ring - 1, Subdivisions > GetRingSubdivision(Ring - 1) ? Sector / 2 : Sector);
+    }
+    return true;
+}
+
+int32 FLabyrinthLayout::GetRotatedCell(int32 CellIndex, int32 Wedge, int32 NumWedges) const
+{
+    const int32 Ring = CellRings[CellIndex];
+    if (Ring == 0)
+    {
+        return 0;
+    }
+
+    const int32 Subdivisions = GetRingSubdivision(Ring);
+    return RingFirstCell[Ring] + (CellIndex - RingFirstCell[Ring] + Wedge * (Subdivisions / NumWedges)) % Subdivisions;
+}
+
+int32 FLabyrinthLayout::GetRotatedWall(int32 WallIndex, int32 Wedge, int32 NumWedges) const
+{
+    if (IsPerimeterWall(WallIndex))
+    {
+        const int32 NumSegments = GetNumPerimeterWalls();
+        return GetPerimeterWall((WallIndex - GetPerimeterWall(0) + Wedge * (NumSegments / NumWedges)) % NumSegments);
+    }
+
+    const int32 CellIndex = GetRotatedCell(GetWallCell(WallIndex), Wedge, NumWedges);
+    return IsRadialWall(WallIndex) ? GetRadialWall(CellIndex) : GetInnerWall(CellIndex);
+}
+
+void FLabyrinthLayout::GetPerimeterWalls(int32 CellIndex, int32& OutFirstWall, int32& OutNumWalls) const
+{
+    const int32 Ring = CellRings[CellIndex];
+    const int32 Ratio = GetNumPerimeterWalls() / GetRingSubdivision(Ring);
+
+    OutFirstWall = GetPerimeterWall((CellIndex - RingFirstCell[Ring]) * Ratio);
+    OutNumWalls = Ratio;
+}
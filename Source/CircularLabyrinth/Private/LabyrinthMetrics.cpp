@@ -0,0 +1,204 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "LabyrinthMetrics.h"
+
+#include "Async/ParallelFor.h"
+
+void FLabyrinthMetricsCalculator::Compute(const FLabyrinthGenerator& Generator, FLabyrinthMetrics& OutMetrics)
+{
+    OutMetrics = FLabyrinthMetrics();
+
+    const FLabyrinthLayout& Layout = Generator.GetLayout();
+    const TBitArray<>& Walls = Generator.Walls;
+    const int32 NumCells = Layout.GetNumCells();
+
+    // gather the open passages & count the openings of every cell
+    Degrees.SetNumUninitialized(NumCells, EAllowShrinking::No);
+    FMemory::Memzero(Degrees.GetData(), NumCells * sizeof(int32));
+    Passages.Reset();
+
+    for (int32 WallIndex = 0; WallIndex < Layout.GetPerimeterWall(0); WallIndex++)
+    {
+        int32 CellA;
+        int32 CellB;
+        if (Walls[WallIndex] || !Layout.GetWallCells(WallIndex, CellA, CellB) || CellA == CellB)
+        {
+            continue;
+        }
+
+        Passages.Add(CellA);
+        Passages.Add(CellB);
+        Degrees[CellA]++;
+        Degrees[CellB]++;
+    }
+
+    // pack the passages per cell, parents are used as fill cursors until the walk
+    LinkOffsets.SetNumUninitialized(NumCells + 1, EAllowShrinking::No);
+    LinkOffsets[0] = 0;
+    for (int32 CellIndex = 0; CellIndex < NumCells; CellIndex++)
+    {
+        LinkOffsets[CellIndex + 1] = LinkOffsets[CellIndex] + Degrees[CellIndex];
+    }
+
+    Links.SetNumUninitialized(Passages.Num(), EAllowShrinking::No);
+    Parents.SetNumUninitialized(NumCells, EAllowShrinking::No);
+    FMemory::Memcpy(Parents.GetData(), LinkOffsets.GetData(), NumCells * sizeof(int32));
+
+    for (int32 PassageIndex = 0; PassageIndex < Passages.Num(); PassageIndex += 2)
+    {
+        const int32 CellA = Passages[PassageIndex];
+        const int32 CellB = Passages[PassageIndex + 1];
+        Links[Parents[CellA]++] = CellB;
+        Links[Parents[CellB]++] = CellA;
+    }
+
+    // breadth first walk from the entrance
+    const int32 RootCell = Generator.EntranceCell != INDEX_NONE ? Generator.EntranceCell : 0;
+    for (int32 CellIndex = 0; CellIndex < NumCells; CellIndex++)
+    {
+        Parents[CellIndex] = INDEX_NONE;
+    }
+
+    Queue.Reset();
+    Queue.Add(RootCell);
+    Parents[RootCell] = RootCell;
+
+    int32 NumLeaves = 0;
+    int32 NumCorridorCells = 0;
+    int32 NumCorridors = 0;
+
+    for (int32 QueueIndex = 0; QueueIndex < Queue.Num(); QueueIndex++)
+    {
+        const int32 CellIndex = Queue[QueueIndex];
+        const int32 Parent = Parents[CellIndex];
+        const int32 Degree = Degrees[CellIndex];
+
+        for (int32 LinkIndex = LinkOffsets[CellIndex]; LinkIndex < LinkOffsets[CellIndex + 1]; LinkIndex++)
+        {
+            const int32 Neighbor = Links[LinkIndex];
+            if (Parents[Neighbor] == INDEX_NONE)
+            {
+                Parents[Neighbor] = CellIndex;
+                Queue.Add(Neighbor);
+            }
+        }
+
+        if (Degree <= 1 && CellIndex != Generator.EntranceCell && CellIndex != Generator.ExitCell)
+        {
+            OutMetrics.NumDeadEnds++;
+        }
+
+        if (Degree - (CellIndex == RootCell ? 0 : 1) <= 0)
+        {
+            NumLeaves++;
+        }
+
+        // a corridor starts on the first of consecutive two openings cells
+        if (Degree == 2)
+        {
+            NumCorridorCells++;
+            if (CellIndex == RootCell || Degrees[Parent] != 2)
+            {
+                NumCorridors++;
+            }
+        }
+    }
+
+    const int32 NumReached = Queue.Num();
+    if (NumReached > NumLeaves)
+    {
+        OutMetrics.BranchingFactor = static_cast<float>(NumReached - 1) / (NumReached - NumLeaves);
+    }
+
+    if (NumCorridors > 0)
+    {
+        OutMetrics.AverageCorridorLength = static_cast<float>(NumCorridorCells) / NumCorridors;
+    }
+
+    // walk back the solution, every opening of a solution cell not on the solution starts a side branch
+    const int32 ExitCell = Generator.ExitCell;
+    if (ExitCell == INDEX_NONE || Parents[ExitCell] == INDEX_NONE)
+    {
+        return;
+    }
+
+    int32 SolutionDegrees = 0;
+    for (int32 CellIndex = ExitCell; ; CellIndex = Parents[CellIndex])
+    {
+        OutMetrics.SolutionLength++;
+        SolutionDegrees += Degrees[CellIndex];
+
+        if (CellIndex == RootCell)
+        {
+            break;
+        }
+    }
+
+    const int32 NumSideBranches = SolutionDegrees - 2 * (OutMetrics.SolutionLength - 1);
+    if (NumSideBranches > 0)
+    {
+        OutMetrics.RiverFactor = static_cast<float>(NumReached - OutMetrics.SolutionLength) / NumSideBranches;
+    }
+}
+
+void SearchLabyrinthSeeds(const FLabyrinthSeedSearchSettings& Settings, TArray<FLabyrinthSeedSearchResult>& OutResults)
+{
+    OutResults.Reset();
+
+    const int32 MaxResults = FMath::Max(Settings.MaxResults, 0);
+    if (Settings.NumSeeds <= 0 || MaxResults == 0)
+    {
+        return;
+    }
+
+    // every seed shares the same layout
+    FLabyrinthLayout Layout;
+    Layout.Init(Settings.Params.MaxRings, Settings.Params.SubdivisionFactor);
+
+    constexpr int64 ChunkSize = 4096;
+    const int32 NumChunks = static_cast<int32>(FMath::DivideAndRoundUp(Settings.NumSeeds, ChunkSize));
+
+    // results stay per chunk so they come out in seed order whatever the scheduling
+    TArray<TArray<FLabyrinthSeedSearchResult>> ChunkResults;
+    ChunkResults.SetNum(NumChunks);
+
+    ParallelFor(NumChunks, [&](int32 ChunkIndex)
+    {
+        FLabyrinthGenerator Generator;
+        FLabyrinthMetricsCalculator Calculator;
+        FLabyrinthGenerationParams Params = Settings.Params;
+        FLabyrinthMetrics Metrics;
+
+        const int64 FirstIndex = ChunkIndex * ChunkSize;
+        const int64 LastIndex = FMath::Min(FirstIndex + ChunkSize, Settings.NumSeeds);
+
+        for (int64 Index = FirstIndex; Index < LastIndex && ChunkResults[ChunkIndex].Num() < MaxResults; Index++)
+        {
+            Params.Seed = static_cast<int32>(Settings.FirstSeed + Index);
+
+            Generator.Begin(Layout, Params);
+            Generator.Run();
+            Calculator.Compute(Generator, Metrics);
+
+            if (Settings.Targets.Matches(Metrics))
+            {
+                FLabyrinthSeedSearchResult& Result = ChunkResults[ChunkIndex].AddDefaulted_GetRef();
+                Result.Seed = Params.Seed;
+                Result.Metrics = Metrics;
+            }
+        }
+    });
+
+    for (const TArray<FLabyrinthSeedSearchResult>& Results : ChunkResults)
+    {
+        for (const FLabyrinthSeedSearchResult& Result : Results)
+        {
+            if (OutResults.Num() == MaxResults)
+            {
+                return;
+            }
+            OutResults.Add(Result);
+        }
+    }
+}
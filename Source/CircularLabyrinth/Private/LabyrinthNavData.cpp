@@ -0,0 +1,409 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "LabyrinthNavData.h"
+
+#include "CircularGrid.h"
+#include "EngineUtils.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogLabyrinthNavData, Log, All);
+
+// the labyrinths edit their cells & walls on the game thread without any lock, queries from other threads are refused
+static bool CanQueryLabyrinths(const TCHAR* QueryName)
+{
+    if (IsInGameThread())
+    {
+        return true;
+    }
+    UE_LOG(LogLabyrinthNavData, Warning, TEXT("%s refused off the game thread, labyrinth queries can't run async"), QueryName);
+    return false;
+}
+
+// one node per cell, shifted by one since 0 is INVALID_NAVNODEREF
+static NavNodeRef GetCellNodeRef(int32 CellIndex)
+{
+    return static_cast<NavNodeRef>(CellIndex) + 1;
+}
+
+static bool GetLabyrinthPathPoints(const ACircularGrid* Labyrinth, const FVector& Start, const FVector& End, TArray<FVector>& OutPoints)
+{
+    if (!Labyrinth)
+    {
+        OutPoints = { Start, End };
+        return true;
+    }
+    return Labyrinth->FindPathPoints(Start, End, OutPoints);
+}
+
+static FVector::FReal GetPathLength(const TArray<FVector>& Points)
+{
+    FVector::FReal Length = 0.0;
+    for (int32 PointIndex = 1; PointIndex < Points.Num(); PointIndex++)
+    {
+        Length += FVector::Dist(Points[PointIndex - 1], Points[PointIndex]);
+    }
+    return Length;
+}
+
+ALabyrinthNavData::ALabyrinthNavData()
+{
+    if (!HasAnyFlags(RF_ClassDefaultObject))
+    {
+        FindPathImplementation = FindPath;
+        FindHierarchicalPathImplementation = FindPath;
+        RaycastImplementation = Raycast;
+    }
+}
+
+void ALabyrinthNavData::InvalidateActivePaths()
+{
+    TArray<FNavPathSharedPtr> Paths;
+    {
+        FScopeLock Lock(&ActivePathsLock);
+        for (const FNavPathWeakPtr& ActivePath : ActivePaths)
+        {
+            if (FNavPathSharedPtr Path = ActivePath.Pin())
+            {
+                Paths.Add(Path);
+            }
+        }
+    }
+
+    // outside of the lock, invalidating requests a repath
+    for (const FNavPathSharedPtr& Path : Paths)
+    {
+        Path->Invalidate();
+    }
+}
+
+void ALabyrinthNavData::RegisterLabyrinth(const ACircularGrid* Labyrinth)
+{
+    Labyrinths.AddUnique(Labyrinth);
+}
+
+void ALabyrinthNavData::UnregisterLabyrinth(const ACircularGrid* Labyrinth)
+{
+    Labyrinths.Remove(Labyrinth);
+}
+
+void ALabyrinthNavData::PostRegisterAllComponents()
+{
+    Super::PostRegisterAllComponents();
+
+    // labyrinths registered before this nav data existed
+    for (TActorIterator<ACircularGrid> It(GetWorld()); It; ++It)
+    {
+        RegisterLabyrinth(*It);
+    }
+}
+
+void ALabyrinthNavData::GetLabyrinths(TArray<const ACircularGrid*, TInlineAllocator<4>>& OutLabyrinths) const
+{
+    if (!CanQueryLabyrinths(TEXT("Labyrinth nav query")))
+    {
+        return;
+    }
+
+    for (const TWeakObjectPtr<const ACircularGrid>& Labyrinth : Labyrinths)
+    {
+        if (const ACircularGrid* Found = Labyrinth.Get())
+        {
+            OutLabyrinths.Add(Found);
+        }
+    }
+}
+
+const ACircularGrid* ALabyrinthNavData::FindLabyrinth(const FVector& Start, const FVector& End) const
+{
+    TArray<const ACircularGrid*, TInlineAllocator<4>> CachedLabyrinths;
+    GetLabyrinths(CachedLabyrinths);
+
+    const ACircularGrid* Found = nullptr;
+    for (const ACircularGrid* Labyrinth : CachedLabyrinths)
+    {
+        FLabyrinthCellCoord Cell;
+        if (Labyrinth->GetCellAtLocation(Start, Cell))
+        {
+            return Labyrinth;
+        }
+        if (!Found && Labyrinth->GetCellAtLocation(End, Cell))
+        {
+            Found = Labyrinth;
+        }
+    }
+    return Found;
+}
+
+FPathFindingResult ALabyrinthNavData::FindPath(const FNavAgentProperties& AgentProperties, const FPathFindingQuery& Query)
+{
+    const ALabyrinthNavData* Self = Cast<const ALabyrinthNavData>(Query.NavData.Get());
+    if (!Self || !CanQueryLabyrinths(TEXT("FindPath")))
+    {
+        return ENavigationQueryResult::Error;
+    }
+
+    FPathFindingResult Result(ENavigationQueryResult::Error);
+    Result.Path = Query.PathInstanceToFill.IsValid() ? Query.PathInstanceToFill : Self->CreatePathInstance<FNavigationPath>(Query);
+
+    FNavigationPath* NavPath = Result.Path.Get();
+    if (!NavPath)
+    {
+        return Result;
+    }
+
+    TArray<FNavPathPoint>& PathPoints = NavPath->GetPathPoints();
+    PathPoints.Reset();
+
+    TArray<FVector> Points;
+    if (!GetLabyrinthPathPoints(Self->FindLabyrinth(Query.StartLocation, Query.EndLocation), Query.StartLocation, Query.EndLocation, Points))
+    {
+        Result.Result = ENavigationQueryResult::Fail;
+        return Result;
+    }
+
+    for (const FVector& Point : Points)
+    {
+        PathPoints.Add(FNavPathPoint(Point));
+    }
+
+    NavPath->MarkReady();
+    Result.Result = ENavigationQueryResult::Success;
+    return Result;
+}
+
+bool ALabyrinthNavData::Raycast(const ANavigationData* NavDataInstance, const FVector& RayStart, const FVector& RayEnd, FVector& HitLocation, FSharedConstNavQueryFilter QueryFilter, const UObject* Querier)
+{
+    HitLocation = RayEnd;
+
+    const ALabyrinthNavData* Self = Cast<const ALabyrinthNavData>(NavDataInstance);
+    if (!Self)
+    {
+        return false;
+    }
+
+    // a refused ray is blocked at its start so nothing takes it as a clear line
+    if (!CanQueryLabyrinths(TEXT("Raycast")))
+    {
+        HitLocation = RayStart;
+        return true;
+    }
+
+    TArray<const ACircularGrid*, TInlineAllocator<4>> CachedLabyrinths;
+    Self->GetLabyrinths(CachedLabyrinths);
+
+    // keep the closest hit over every labyrinth
+    bool bHit = false;
+    for (const ACircularGrid* Labyrinth : CachedLabyrinths)
+    {
+        FVector LabyrinthHit;
+        if (Labyrinth->RaycastWalls(RayStart, RayEnd, LabyrinthHit) && (!bHit || FVector::DistSquared(RayStart, LabyrinthHit) < FVector::DistSquared(RayStart, HitLocation)))
+        {
+            HitLocation = LabyrinthHit;
+            bHit = true;
+        }
+    }
+    return bHit;
+}
+
+FBox ALabyrinthNavData::GetBounds() const
+{
+    TArray<const ACircularGrid*, TInlineAllocator<4>> CachedLabyrinths;
+    GetLabyrinths(CachedLabyrinths);
+
+    FBox Bounds(ForceInit);
+    for (const ACircularGrid* Labyrinth : CachedLabyrinths)
+    {
+        const FVector Extent(Labyrinth->GetOuterRadius(), Labyrinth->GetOuterRadius(), 0.0f);
+        Bounds += FBox(Labyrinth->GetActorLocation() - Extent, Labyrinth->GetActorLocation() + Extent);
+    }
+    return Bounds;
+}
+
+FNavLocation ALabyrinthNavData::GetRandomPoint(FSharedConstNavQueryFilter Filter, const UObject* Querier) const
+{
+    TArray<const ACircularGrid*, TInlineAllocator<4>> CachedLabyrinths;
+    GetLabyrinths(CachedLabyrinths);
+    CachedLabyrinths.RemoveAllSwap([](const ACircularGrid* Labyrinth) { return Labyrinth->Cells.Num() == 0; });
+
+    if (CachedLabyrinths.IsEmpty())
+    {
+        return FNavLocation();
+    }
+
+    const ACircularGrid* Labyrinth = CachedLabyrinths[FMath::RandHelper(CachedLabyrinths.Num())];
+    const int32 CellIndex = FMath::RandHelper(Labyrinth->Cells.Num());
+    return FNavLocation(Labyrinth->GetCellWorldLocation(CellIndex), GetCellNodeRef(CellIndex));
+}
+
+bool ALabyrinthNavData::GetRandomReachablePointInRadius(const FVector& Origin, float Radius, FNavLocation& OutResult, FSharedConstNavQueryFilter Filter, const UObject* Querier) const
+{
+    FLabyrinthCellCoord OriginCell;
+    const ACircularGrid* Labyrinth = FindLabyrinth(Origin, Origin);
+    if (!Labyrinth || !Labyrinth->GetCellAtLocation(Origin, OriginCell))
+    {
+        return false;
+    }
+
+    TArray<int32> CandidateCells;
+    for (int32 CellIndex = 0; CellIndex < Labyrinth->Cells.Num(); CellIndex++)
+    {
+        if (FVector::Dist2D(Labyrinth->GetCellWorldLocation(CellIndex), Origin) <= Radius)
+        {
+            CandidateCells.Add(CellIndex);
+        }
+    }
+
+    // a perfect labyrinth reaches every cell, only walls closed at runtime can cut some off
+    TArray<int32> CellPath;
+    for (int32 Attempt = 0; Attempt < 8 && CandidateCells.Num() > 0; Attempt++)
+    {
+        const int32 CandidateIndex = FMath::RandHelper(CandidateCells.Num());
+        if (Labyrinth->FindCellPath(OriginCell.Index, CandidateCells[CandidateIndex], CellPath))
+        {
+            OutResult = FNavLocation(Labyrinth->GetCellWorldLocation(CandidateCells[CandidateIndex]), GetCellNodeRef(CandidateCells[CandidateIndex]));
+            return true;
+        }
+        CandidateCells.RemoveAtSwap(CandidateIndex);
+    }
+    return false;
+}
+
+bool ALabyrinthNavData::GetRandomPointInNavigableRadius(const FVector& Origin, float Radius, FNavLocation& OutResult, FSharedConstNavQueryFilter Filter, const UObject* Querier) const
+{
+    // only cells are navigable, there's nothing to pick outside of the labyrinths
+    const ACircularGrid* Labyrinth = FindLabyrinth(Origin, Origin);
+    if (!Labyrinth)
+    {
+        return false;
+    }
+
+    TArray<int32> CandidateCells;
+    for (int32 CellIndex = 0; CellIndex < Labyrinth->Cells.Num(); CellIndex++)
+    {
+        if (FVector::Dist2D(Labyrinth->GetCellWorldLocation(CellIndex), Origin) <= Radius)
+        {
+            CandidateCells.Add(CellIndex);
+        }
+    }
+
+    if (CandidateCells.IsEmpty())
+    {
+        return false;
+    }
+
+    const int32 CellIndex = CandidateCells[FMath::RandHelper(CandidateCells.Num())];
+    OutResult = FNavLocation(Labyrinth->GetCellWorldLocation(CellIndex), GetCellNodeRef(CellIndex));
+    return true;
+}
+
+bool ALabyrinthNavData::ProjectPoint(const FVector& Point, FNavLocation& OutLocation, const FVector& Extent, FSharedConstNavQueryFilter Filter, const UObject* Querier) const
+{
+    TArray<const ACircularGrid*, TInlineAllocator<4>> CachedLabyrinths;
+    GetLabyrinths(CachedLabyrinths);
+
+    // a point stays where it is in its cell, kept off the walls & moved to the cell height. A zero extent doesn't limit the height.
+    for (const ACircularGrid* Labyrinth : CachedLabyrinths)
+    {
+        FLabyrinthCellCoord Cell;
+        if (!Labyrinth->GetCellAtLocation(Point, Cell))
+        {
+            continue;
+        }
+
+        const FVector ProjectedLocation = Labyrinth->ClampToCell(Point, Cell.Index);
+        if (Extent.Z > 0.0 && FMath::Abs(ProjectedLocation.Z - Point.Z) > Extent.Z)
+        {
+            continue;
+        }
+
+        OutLocation = FNavLocation(ProjectedLocation, GetCellNodeRef(Cell.Index));
+        return true;
+    }
+
+    // outside of every labyrinth isn't on the graph
+    return false;
+}
+
+void ALabyrinthNavData::BatchProjectPoints(TArray<FNavigationProjectionWork>& Workload, const FVector& Extent, FSharedConstNavQueryFilter Filter, const UObject* Querier) const
+{
+    for (FNavigationProjectionWork& Work : Workload)
+    {
+        Work.bResult = ProjectPoint(Work.Point, Work.OutLocation, Extent, Filter, Querier);
+    }
+}
+
+void ALabyrinthNavData::BatchProjectPoints(TArray<FNavigationProjectionWork>& Workload, FSharedConstNavQueryFilter Filter, const UObject* Querier) const
+{
+    BatchProjectPoints(Workload, FVector::ZeroVector, Filter, Querier);
+}
+
+ENavigationQueryResult::Type ALabyrinthNavData::CalcPathCost(const FVector& PathStart, const FVector& PathEnd, FVector::FReal& OutPathCost, FSharedConstNavQueryFilter QueryFilter, const UObject* Querier) const
+{
+    FVector::FReal PathLength;
+    return CalcPathLengthAndCost(PathStart, PathEnd, PathLength, OutPathCost, QueryFilter, Querier);
+}
+
+ENavigationQueryResult::Type ALabyrinthNavData::CalcPathLength(const FVector& PathStart, const FVector& PathEnd, FVector::FReal& OutPathLength, FSharedConstNavQueryFilter QueryFilter, const UObject* Querier) const
+{
+    FVector::FReal PathCost;
+    return CalcPathLengthAndCost(PathStart, PathEnd, OutPathLength, PathCost, QueryFilter, Querier);
+}
+
+ENavigationQueryResult::Type ALabyrinthNavData::CalcPathLengthAndCost(const FVector& PathStart, const FVector& PathEnd, FVector::FReal& OutPathLength, FVector::FReal& OutPathCost, FSharedConstNavQueryFilter QueryFilter, const UObject* Querier) const
+{
+    if (!CanQueryLabyrinths(TEXT("CalcPathLengthAndCost")))
+    {
+        return ENavigationQueryResult::Error;
+    }
+
+    TArray<FVector> Points;
+    if (!GetLabyrinthPathPoints(FindLabyrinth(PathStart, PathEnd), PathStart, PathEnd, Points))
+    {
+        return ENavigationQueryResult::Fail;
+    }
+
+    // no area costs, the cost is the walked distance
+    OutPathLength = GetPathLength(Points);
+    OutPathCost = OutPathLength;
+    return ENavigationQueryResult::Success;
+}
+
+bool ALabyrinthNavData::DoesNodeContainLocation(NavNodeRef NodeRef, const FVector& WorldSpaceLocation) const
+{
+    TArray<const ACircularGrid*, TInlineAllocator<4>> CachedLabyrinths;
+    GetLabyrinths(CachedLabyrinths);
+
+    for (const ACircularGrid* Labyrinth : CachedLabyrinths)
+    {
+        FLabyrinthCellCoord Cell;
+        if (Labyrinth->GetCellAtLocation(WorldSpaceLocation, Cell))
+        {
+            return GetCellNodeRef(Cell.Index) == NodeRef;
+        }
+    }
+    return false;
+}
+
+void ALabyrinthNavData::BatchRaycast(TArray<FNavigationRaycastWork>& Workload, FSharedConstNavQueryFilter QueryFilter, const UObject* Querier) const
+{
+    for (FNavigationRaycastWork& Work : Workload)
+    {
+        FVector HitLocation;
+        Work.bDidHit = Raycast(this, Work.RayStart, Work.RayEnd, HitLocation, QueryFilter, Querier);
+        Work.HitLocation = FNavLocation(HitLocation);
+    }
+}
+
+bool ALabyrinthNavData::FindMoveAlongSurface(const FNavLocation& StartLocation, const FVector& TargetPosition, FNavLocation& OutLocation, FSharedConstNavQueryFilter Filter, const UObject* Querier) const
+{
+    if (!CanQueryLabyrinths(TEXT("FindMoveAlongSurface")))
+    {
+        return false;
+    }
+
+    // slide up to the first standing wall
+    FVector HitLocation;
+    Raycast(this, StartLocation.Location, TargetPosition, HitLocation, Filter, Querier);
+    OutLocation = FNavLocation(HitLocation);
+    return true;
+}
@@ -0,0 +1,86 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "LabyrinthNetRelay.h"
+
+#include "CircularGrid.h"
+#include "EngineUtils.h"
+#include "GameFramework/GameModeBase.h"
+#include "GameFramework/PlayerController.h"
+
+ULabyrinthNetRelay::ULabyrinthNetRelay()
+{
+    PrimaryComponentTick.bCanEverTick = false;
+    SetIsReplicatedByDefault(true);
+}
+
+void ULabyrinthNetRelay::BeginPlay()
+{
+    Super::BeginPlay();
+
+    // labyrinths that asked for their walls before this relay replicated
+    const APlayerController* PlayerController = GetOwner<APlayerController>();
+    if (!PlayerController || PlayerController->HasAuthority() || !PlayerController->IsLocalController())
+    {
+        return;
+    }
+
+    for (TActorIterator<ACircularGrid> It(GetWorld()); It; ++It)
+    {
+        if (It->IsWaitingForAuthorityWalls())
+        {
+            ServerRequestWalls(*It);
+        }
+    }
+}
+
+void ULabyrinthNetRelay::AddToPlayers(UWorld* World)
+{
+    static FDelegateHandle PostLoginHandle;
+    if (!PostLoginHandle.IsValid())
+    {
+        PostLoginHandle = FGameModeEvents::GameModePostLoginEvent.AddLambda([](AGameModeBase* GameMode, APlayerController* NewPlayer)
+        {
+            AddToPlayer(NewPlayer);
+        });
+    }
+
+    for (FConstPlayerControllerIterator It = World->GetPlayerControllerIterator(); It; ++It)
+    {
+        AddToPlayer(It->Get());
+    }
+}
+
+void ULabyrinthNetRelay::AddToPlayer(APlayerController* PlayerController)
+{
+    if (!PlayerController || !PlayerController->HasAuthority() || PlayerController->FindComponentByClass<ULabyrinthNetRelay>())
+    {
+        return;
+    }
+
+    ULabyrinthNetRelay* Relay = NewObject<ULabyrinthNetRelay>(PlayerController);
+    Relay->RegisterComponent();
+}
+
+ULabyrinthNetRelay* ULabyrinthNetRelay::FindLocal(const UWorld* World)
+{
+    const APlayerController* PlayerController = World ? World->GetFirstPlayerController() : nullptr;
+    return PlayerController ? PlayerController->FindComponentByClass<ULabyrinthNetRelay>() : nullptr;
+}
+
+void ULabyrinthNetRelay::ServerRequestWalls_Implementation(ACircularGrid* Labyrinth)
+{
+    FLabyrinthNetState State;
+    if (Labyrinth && Labyrinth->MakeWallsNetState(State))
+    {
+        ClientReceiveWalls(Labyrinth, State);
+    }
+}
+
+void ULabyrinthNetRelay::ClientReceiveWalls_Implementation(ACircularGrid* Labyrinth, const FLabyrinthNetState& State)
+{
+    if (Labyrinth)
+    {
+        Labyrinth->ReceiveAuthorityWalls(State);
+    }
+}
@@ -0,0 +1,355 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "LabyrinthValidation.h"
+
+#include "Async/ParallelFor.h"
+#include "HAL/IConsoleManager.h"
+#include <atomic>
+
+DEFINE_LOG_CATEGORY_STATIC(LogLabyrinthValidation, Log, All);
+
+const TCHAR* LexToString(ELabyrinthDefect Defect)
+{
+    switch (Defect)
+    {
+    case ELabyrinthDefect::None:                return TEXT("None");
+    case ELabyrinthDefect::AsymmetricNeighbors: return TEXT("AsymmetricNeighbors");
+    case ELabyrinthDefect::UnrelatedWall:       return TEXT("UnrelatedWall");
+    case ELabyrinthDefect::OneWayWall:          return TEXT("OneWayWall");
+    case ELabyrinthDefect::Cycle:               return TEXT("Cycle");
+    case ELabyrinthDefect::Disconnected:        return TEXT("Disconnected");
+    case ELabyrinthDefect::ClosedEntrance:      return TEXT("ClosedEntrance");
+    case ELabyrinthDefect::ClosedExit:          return TEXT("ClosedExit");
+    }
+    return TEXT("Unknown");
+}
+
+ELabyrinthDefect FLabyrinthValidator::Validate(const FLabyrinthGenerator& Generator)
+{
+    const FLabyrinthLayout& Layout = Generator.GetLayout();
+    const TBitArray<>& Walls = Generator.Walls;
+    const int32 NumCells = Layout.GetNumCells();
+
+    Parents.SetNumUninitialized(NumCells, EAllowShrinking::No);
+    for (int32 CellIndex = 0; CellIndex < NumCells; CellIndex++)
+    {
+        Parents[CellIndex] = CellIndex;
+    }
+
+    // every open wall joins two cells, joining two cells already connected makes a loop
+    int32 NumComponents = NumCells;
+    for (int32 WallIndex = 0; WallIndex < Layout.GetPerimeterWall(0); WallIndex++)
+    {
+        int32 CellA;
+        int32 CellB;
+        if (Walls[WallIndex] || !Layout.GetWallCells(WallIndex, CellA, CellB) || CellA == CellB)
+        {
+            continue;
+        }
+
+        const int32 RootA = FindRoot(CellA);
+        const int32 RootB = FindRoot(CellB);
+        if (RootA == RootB)
+        {
+            return ELabyrinthDefect::Cycle;
+        }
+
+        Parents[RootA] = RootB;
+        NumComponents--;
+    }
+
+    if (NumComponents != 1)
+    {
+        return ELabyrinthDefect::Disconnected;
+    }
+
+    // perimeter entrance & exit need an opening in front of their cell
+    auto IsPerimeterOpen = [&Layout, &Walls](int32 CellIndex)
+    {
+        if (CellIndex == INDEX_NONE || Layout.GetCellRing(CellIndex) != Layout.GetOuterRing())
+        {
+            return false;
+        }
+
+        int32 FirstWall;
+        int32 NumWalls;
+        Layout.GetPerimeterWalls(CellIndex, FirstWall, NumWalls);
+        for (int32 WallIndex = FirstWall; WallIndex < FirstWall + NumWalls; WallIndex++)
+        {
+            if (!Walls[WallIndex])
+            {
+                return true;
+            }
+        }
+        return false;
+    };
+
+    const FLabyrinthGenerationParams& Params = Generator.GetParams();
+
+    if (Generator.EntranceCell == INDEX_NONE || (Params.StartPath == ELabyrinthStart::Perimeter && !IsPerimeterOpen(Generator.EntranceCell)))
+    {
+        return ELabyrinthDefect::ClosedEntrance;
+    }
+
+    if (Generator.ExitCell == INDEX_NONE || (Params.EndPath != ELabyrinthExit::Center && !IsPerimeterOpen(Generator.ExitCell)))
+    {
+        return ELabyrinthDefect::ClosedExit;
+    }
+
+    return ELabyrinthDefect::None;
+}
+
+ELabyrinthDefect FLabyrinthValidator::ValidateNeighbors(const FLabyrinthLayout& Layout)
+{
+    // sides every wall is crossed from walking the neighbor slots, one bit per cell of the wall
+    TArray<uint8> WallCrossings;
+    WallCrossings.SetNumZeroed(Layout.GetPerimeterWall(0));
+
+    for (int32 CellIndex = 0; CellIndex < Layout.GetNumCells(); CellIndex++)
+    {
+        const TConstArrayView<int32> Neighbors = Layout.GetNeighbors(CellIndex);
+        for (int32 NeighborSlot = 0; NeighborSlot < Neighbors.Num(); NeighborSlot++)
+        {
+            const int32 Neighbor = Neighbors[NeighborSlot];
+
+            // a ring with a single sector is its own left & right neighbor
+            if (Neighbor == CellIndex)
+            {
+                continue;
+            }
+
+            if (!Layout.GetNeighbors(Neighbor).Contains(CellIndex))
+            {
+                return ELabyrinthDefect::AsymmetricNeighbors;
+            }
+
+            int32 CellA;
+            int32 CellB;
+            if (!Layout.GetWallCells(Layout.GetWallBetween(CellIndex, Neighbor), CellA, CellB)
+                || !((CellA == CellIndex && CellB == Neighbor) || (CellA == Neighbor && CellB == CellIndex)))
+            {
+                return ELabyrinthDefect::UnrelatedWall;
+            }
+
+            const int32 WallIndex = Layout.GetNeighborWall(CellIndex, NeighborSlot);
+            if (!Layout.GetWallCells(WallIndex, CellA, CellB)
+                || !((CellA == CellIndex && CellB == Neighbor) || (CellA == Neighbor && CellB == CellIndex)))
+            {
+                return ELabyrinthDefect::UnrelatedWall;
+            }
+            WallCrossings[WallIndex] |= CellA == CellIndex ? 1 : 2;
+        }
+    }
+
+    // a walk over the open walls must go both ways through every passage
+    for (int32 WallIndex = 0; WallIndex < WallCrossings.Num(); WallIndex++)
+    {
+        int32 CellA;
+        int32 CellB;
+        Layout.GetWallCells(WallIndex, CellA, CellB);
+        if (CellA != CellB && WallCrossings[WallIndex] != 3)
+        {
+            return ELabyrinthDefect::OneWayWall;
+        }
+    }
+
+    return ELabyrinthDefect::None;
+}
+
+int32 FLabyrinthValidator::FindRoot(int32 CellIndex)
+{
+    // path halving
+    while (Parents[CellIndex] != CellIndex)
+    {
+        Parents[CellIndex] = Parents[Parents[CellIndex]];
+        CellIndex = Parents[CellIndex];
+    }
+    return CellIndex;
+}
+
+static FLabyrinthGenerationParams MakeFuzzParams(const FLabyrinthFuzzSettings& Settings, int64 Iteration)
+{
+    // the seed follows the iteration, a cheap hash of it picks the other params
+    uint32 Hash = static_cast<uint32>(Iteration) * 0x9E3779B1u ^ static_cast<uint32>(Iteration >> 32);
+    Hash ^= Hash >> 16;
+    Hash *= 0x85EBCA6Bu;
+    Hash ^= Hash >> 13;
+
+    const uint32 NumRings = Settings.MaxRings - Settings.MinRings + 1;
+    const uint32 NumSubdivisionFactors = Settings.MaxSubdivisionFactor + 1;
+
+    FLabyrinthGenerationParams Params;
+    Params.Seed = Settings.FirstSeed + static_cast<int32>(Iteration);
+    Params.MaxRings = Settings.MinRings + Hash % NumRings;
+    Hash /= NumRings;
+    Params.SubdivisionFactor = Hash % NumSubdivisionFactors;
+    Hash /= NumSubdivisionFactors;
+    Params.StartPath = static_cast<ELabyrinthStart>(Hash % 2);
+    Hash /= 2;
+    Params.EndPath = static_cast<ELabyrinthExit>(Hash % 3);
+    Hash /= 3;
+
+    // a quarter of the labyrinths are symmetric, the generator clamps the fold to the first ring
+    Params.SymmetryFold = Hash % 4 == 0 ? 2 << (Hash / 4 % 3) : 1;
+    return Params;
+}
+
+static void ShrinkFailure(const FLabyrinthFuzzSettings& Settings, FLabyrinthFuzzFailure& Failure)
+{
+    FLabyrinthLayout Layout;
+    FLabyrinthGenerator Generator;
+    FLabyrinthValidator Validator;
+
+    // smallest rings, subdivision & symmetry fold giving the same defect with the same seed, start, exit & seam openings
+    for (int32 Rings = Settings.MinRings; Rings <= Failure.OriginalParams.MaxRings; Rings++)
+    {
+        for (int32 SubdivisionFactor = 0; SubdivisionFactor <= Failure.OriginalParams.SubdivisionFactor; SubdivisionFactor++)
+        {
+            Layout.Init(Rings, SubdivisionFactor);
+
+            for (int32 SymmetryFold = 1; SymmetryFold <= Failure.OriginalParams.SymmetryFold; SymmetryFold *= 2)
+            {
+                FLabyrinthGenerationParams Candidate = Failure.OriginalParams;
+                Candidate.MaxRings = Rings;
+                Candidate.SubdivisionFactor = SubdivisionFactor;
+                Candidate.SymmetryFold = SymmetryFold;
+
+                Generator.Begin(Layout, Candidate);
+                Generator.Run();
+
+                // the generator clamps the fold to the first ring, report the one it ran with
+                if (Validator.Validate(Generator) == Failure.Defect)
+                {
+                    Candidate.SymmetryFold = Generator.GetNumWedges();
+                    Failure.Params = Candidate;
+                    return;
+                }
+            }
+        }
+    }
+}
+
+void FuzzLabyrinths(const FLabyrinthFuzzSettings& InSettings, TArray<FLabyrinthFuzzFailure>& OutFailures, FLabyrinthFuzzStats& OutStats)
+{
+    const double StartTime = FPlatformTime::Seconds();
+
+    FLabyrinthFuzzSettings Settings = InSettings;
+    Settings.MinRings = FMath::Max(Settings.MinRings, 1);
+    Settings.MaxRings = FMath::Max(Settings.MaxRings, Settings.MinRings);
+    Settings.MaxSubdivisionFactor = FMath::Clamp(Settings.MaxSubdivisionFactor, 0, 10);
+
+    OutFailures.Reset();
+    OutStats = FLabyrinthFuzzStats();
+
+    // layouts only depend on rings & subdivision, built once and shared by every worker
+    const int32 NumSubdivisionFactors = Settings.MaxSubdivisionFactor + 1;
+    TArray<FLabyrinthLayout> Layouts;
+    Layouts.SetNum((Settings.MaxRings - Settings.MinRings + 1) * NumSubdivisionFactors);
+
+    for (int32 Rings = Settings.MinRings; Rings <= Settings.MaxRings; Rings++)
+    {
+        for (int32 SubdivisionFactor = 0; SubdivisionFactor < NumSubdivisionFactors; SubdivisionFactor++)
+        {
+            FLabyrinthLayout& Layout = Layouts[(Rings - Settings.MinRings) * NumSubdivisionFactors + SubdivisionFactor];
+            Layout.Init(Rings, SubdivisionFactor);
+
+            // a broken layout fails every seed, report it once
+            const ELabyrinthDefect Defect = FLabyrinthValidator::ValidateNeighbors(Layout);
+            if (Defect != ELabyrinthDefect::None && OutFailures.Num() < Settings.MaxReportedFailures)
+            {
+                FLabyrinthFuzzFailure& Failure = OutFailures.AddDefaulted_GetRef();
+                Failure.Params.MaxRings = Rings;
+                Failure.Params.SubdivisionFactor = SubdivisionFactor;
+                Failure.OriginalParams = Failure.Params;
+                Failure.Defect = Defect;
+            }
+        }
+    }
+
+    const int32 NumLayoutFailures = OutFailures.Num();
+
+    std::atomic<int64> NumCells(0);
+    std::atomic<int64> NumFailures(0);
+    FCriticalSection FailuresLock;
+
+    constexpr int64 ChunkSize = 4096;
+    const int32 NumChunks = static_cast<int32>(FMath::DivideAndRoundUp(FMath::Max<int64>(Settings.NumIterations, 0), ChunkSize));
+
+    ParallelFor(NumChunks, [&](int32 ChunkIndex)
+    {
+        FLabyrinthGenerator Generator;
+        FLabyrinthValidator Validator;
+        int64 ChunkCells = 0;
+
+        const int64 FirstIteration = ChunkIndex * ChunkSize;
+        const int64 LastIteration = FMath::Min(FirstIteration + ChunkSize, Settings.NumIterations);
+
+        for (int64 Iteration = FirstIteration; Iteration < LastIteration; Iteration++)
+        {
+            const FLabyrinthGenerationParams Params = MakeFuzzParams(Settings, Iteration);
+            const FLabyrinthLayout& Layout = Layouts[(Params.MaxRings - Settings.MinRings) * NumSubdivisionFactors + Params.SubdivisionFactor];
+
+            Generator.Begin(Layout, Params);
+            Generator.Run();
+            ChunkCells += Layout.GetNumCells();
+
+            const ELabyrinthDefect Defect = Validator.Validate(Generator);
+            if (Defect != ELabyrinthDefect::None)
+            {
+                NumFailures++;
+
+                FScopeLock Lock(&FailuresLock);
+                if (OutFailures.Num() < Settings.MaxReportedFailures)
+                {
+                    FLabyrinthFuzzFailure& Failure = OutFailures.AddDefaulted_GetRef();
+                    Failure.Params = Params;
+                    Failure.OriginalParams = Params;
+                    Failure.Defect = Defect;
+                }
+            }
+        }
+
+        NumCells += ChunkCells;
+    });
+
+    // reported failures are few, shrink them one by one
+    for (int32 FailureIndex = NumLayoutFailures; FailureIndex < OutFailures.Num(); FailureIndex++)
+    {
+        ShrinkFailure(Settings, OutFailures[FailureIndex]);
+    }
+
+    OutStats.NumIterations = FMath::Max<int64>(Settings.NumIterations, 0);
+    OutStats.NumCells = NumCells;
+    OutStats.NumFailures = NumFailures + NumLayoutFailures;
+    OutStats.Seconds = FPlatformTime::Seconds() - StartTime;
+}
+
+// Labyrinth.Fuzz [NumIterations] [MaxRings] [MaxSubdivisionFactor] [FirstSeed]
+static FAutoConsoleCommand CmdLabyrinthFuzz(
+    TEXT("Labyrinth.Fuzz"),
+    TEXT("Generate & validate random labyrinths on every core: Labyrinth.Fuzz [NumIterations] [MaxRings] [MaxSubdivisionFactor] [FirstSeed]"),
+    FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+    {
+        FLabyrinthFuzzSettings Settings;
+        if (Args.IsValidIndex(0)) Settings.NumIterations = FCString::Atoi64(*Args[0]);
+        if (Args.IsValidIndex(1)) Settings.MaxRings = FCString::Atoi(*Args[1]);
+        if (Args.IsValidIndex(2)) Settings.MaxSubdivisionFactor = FCString::Atoi(*Args[2]);
+        if (Args.IsValidIndex(3)) Settings.FirstSeed = FCString::Atoi(*Args[3]);
+
+        TArray<FLabyrinthFuzzFailure> Failures;
+        FLabyrinthFuzzStats Stats;
+        FuzzLabyrinths(Settings, Failures, Stats);
+
+        UE_LOG(LogLabyrinthValidation, Display, TEXT("%lld labyrinths, %lld cells in %.2fs (%.1f M cells/s), %lld failures"),
+            Stats.NumIterations, Stats.NumCells, Stats.Seconds, Stats.NumCells / FMath::Max(Stats.Seconds, UE_DOUBLE_SMALL_NUMBER) / 1.0e6, Stats.NumFailures);
+
+        for (const FLabyrinthFuzzFailure& Failure : Failures)
+        {
+            UE_LOG(LogLabyrinthValidation, Warning, TEXT("%s: Seed=%d MaxRings=%d SubdivisionFactor=%d StartPath=%d EndPath=%d SymmetryFold=%d SymmetrySeamOpenings=%d (found with MaxRings=%d SubdivisionFactor=%d SymmetryFold=%d)"),
+                LexToString(Failure.Defect), Failure.Params.Seed, Failure.Params.MaxRings, Failure.Params.SubdivisionFactor,
+                static_cast<int32>(Failure.Params.StartPath), static_cast<int32>(Failure.Params.EndPath),
+                Failure.Params.SymmetryFold, Failure.Params.SymmetrySeamOpenings,
+                Failure.OriginalParams.MaxRings, Failure.OriginalParams.SubdivisionFactor, Failure.OriginalParams.SymmetryFold);
+        }
+    }));
@@ -4,11 +4,16 @@
 #include "ELabyrinthExit.h"
 #include "ELabyrinthStart.h"
 #include "SLabyrinthCell.h"
+#include "SLabyrinthCellCoord.h"
+#include "SLabyrinthNetState.h"
+#include "LabyrinthGenerator.h"
+#include "LabyrinthMetrics.h"
 #include "Kismet/KismetArrayLibrary.h"
 #include "Kismet/KismetSystemLibrary.h"
 #include "GameFramework/Actor.h"
 #include "Components/HierarchicalInstancedStaticMeshComponent.h"
 #include "Components/TextRenderComponent.h"
+#include "UObject/ObjectSaveContext.h"
 #include "CircularGrid.generated.h"
 
 UCLASS()
@@ -45,23 +50,87 @@ public:
 	UPROPERTY(EditAnywhere, Category = "Grid Settings")
 	ELabyrinthExit EndPath;
 
+	// k-fold rotational symmetry, a power of two no bigger than the first ring subdivision. Only one wedge is carved.
+	UPROPERTY(EditAnywhere, Category = "Grid Settings|Symmetry")
+	int32 SymmetryFold = 1;
+
+	// Passages on each seam between two wedges, more than one makes loops
+	UPROPERTY(EditAnywhere, Category = "Grid Settings|Symmetry")
+	int32 SymmetrySeamOpenings = 1;
+
 	UPROPERTY(EditAnywhere, Category = "Grid Settings")
 	float AnimationDelay = 0.0f;
 	
 	UPROPERTY(EditAnywhere, Category = "Grid Settings")
 	bool DebugIndex;
 
+	// Show the cells on the backtracking stack while the labyrinth is generated
+	UPROPERTY(EditAnywhere, Category = "Grid Settings")
+	bool bShowBacktrackingStack = false;
+
+	// Generate in the editor or at cook time and store the result, nothing is generated at runtime
+	UPROPERTY(EditAnywhere, Category = "Grid Settings|Bake")
+	bool bBakeLabyrinth = false;
+
+	UPROPERTY(VisibleAnywhere, Category = "Grid Settings|Bake")
+	int32 BakedEntranceCell = INDEX_NONE;
+
+	UPROPERTY(VisibleAnywhere, Category = "Grid Settings|Bake")
+	int32 BakedExitCell = INDEX_NONE;
+
+	UFUNCTION(CallInEditor, Category = "Grid Settings|Bake")
+	void BakeLabyrinth();
+
+	// Ranges the labyrinth metrics should be in, searched with the current rings, subdivision, start & exit
+	UPROPERTY(EditAnywhere, Category = "Grid Settings|Seed Search")
+	FLabyrinthMetricsTargets SeedSearchTargets;
+
+	UPROPERTY(EditAnywhere, Category = "Grid Settings|Seed Search")
+	int32 NumSearchedSeeds = 1000000;
+
+	UPROPERTY(VisibleAnywhere, Category = "Grid Settings|Seed Search")
+	TArray<FLabyrinthSeedSearchResult> FoundSeeds;
+
+	// Scan seeds on every core and switch to the first one matching the targets
+	UFUNCTION(CallInEditor, Category = "Grid Settings|Seed Search")
+	void FindSeeds();
+
+	// Walls can be made purely visual, gameplay then relies on the grid queries instead of physics
+	UPROPERTY(EditAnywhere, Category = "Grid Settings")
+	bool bWallCollision = true;
+
+	// Let walls & pillars dirty the navmesh, turn it off when agents use ALabyrinthNavData so nothing gets rebuilt around the instances
+	UPROPERTY(EditAnywhere, Category = "Grid Settings|Navigation")
+	bool bWallsAffectNavigation = true;
+
+	// Always send the wall bits to joining clients instead of letting them regenerate from the params
+	UPROPERTY(EditAnywhere, Category = "Grid Settings|Replication")
+	bool bAlwaysReplicateWalls = false;
+
 	UPROPERTY(EditDefaultsOnly)
 	UHierarchicalInstancedStaticMeshComponent* CircularWalls;
 
 	UPROPERTY(EditDefaultsOnly)
 	UHierarchicalInstancedStaticMeshComponent* Pillars;
 
+	// Path marker & backtracking stack change every animation step, plain instances skip the HISM cluster tree rebuilds
 	UPROPERTY(EditDefaultsOnly)
-	UHierarchicalInstancedStaticMeshComponent* Path;
+	UInstancedStaticMeshComponent* Path;
+
+	// Uses the Path mesh when none is set
+	UPROPERTY(EditDefaultsOnly)
+	UInstancedStaticMeshComponent* PathStack;
 	
 	virtual void OnConstruction(const FTransform& Transform) override;
 
+	// Keeps the ALabyrinthNavData caches of the world up to date
+	virtual void PostRegisterAllComponents() override;
+	virtual void PostUnregisterAllComponents() override;
+
+#if WITH_EDITOR
+	virtual void PreSave(FObjectPreSaveContext ObjectSaveContext) override;
+#endif
+
 	UPROPERTY(BlueprintReadWrite, Category = "Grid Data")
 	TArray<FLabyrinthCell> Cells;
 
@@ -71,55 +140,150 @@ public:
 	UFUNCTION(BlueprintCallable)
 	void TestCellNeighbors(int32 index);
 
+	UFUNCTION(BlueprintCallable)
+	int32 GetWallBetween(int32 CellIndex1, int32 CellIndex2) const;
+
+	UFUNCTION(BlueprintCallable)
+	bool IsWallOpen(int32 WallIndex) const;
+
+	UFUNCTION(BlueprintPure)
+	int32 GetEntranceCell() const { return Generator.EntranceCell; }
+
+	UFUNCTION(BlueprintPure)
+	int32 GetExitCell() const { return Generator.ExitCell; }
+
+	// Open or close walls once the labyrinth is generated, authority only. Clients receive the change as a single delta packet.
+	UFUNCTION(BlueprintCallable, BlueprintAuthorityOnly)
+	void SetWallsOpen(const TArray<int32>& WallIndices, bool bOpen);
 
+	// Net state with the wall bits, false until the generation is finished
+	bool MakeWallsNetState(FLabyrinthNetState& OutState) const;
+
+	// Authority walls sent back to a client whose regeneration didn't match the checksum
+	void ReceiveAuthorityWalls(const FLabyrinthNetState& State);
+	bool IsWaitingForAuthorityWalls() const { return bWaitingForAuthorityWalls; }
+
+	// Cell under a world location, false outside of the labyrinth
+	UFUNCTION(BlueprintCallable, Category = "Grid Queries")
+	bool GetCellAtLocation(FVector WorldLocation, FLabyrinthCellCoord& OutCell) const;
+
+	// First standing wall crossed going from Start to End, heights are ignored
+	UFUNCTION(BlueprintCallable, Category = "Grid Queries")
+	bool DoesSegmentCrossWall(FVector Start, FVector End, int32& OutWallIndex) const;
+
+	// Difficulty of the generated labyrinth, false until the generation is finished
+	UFUNCTION(BlueprintCallable, Category = "Grid Queries")
+	bool GetMetrics(FLabyrinthMetrics& OutMetrics) const;
+
+	UFUNCTION(BlueprintCallable, Category = "Grid Queries")
+	void BatchSegmentsCrossWall(const TArray<FVector>& Starts, const TArray<FVector>& Ends, TArray<bool>& OutHits) const;
+
+	// Same as DoesSegmentCrossWall with the location the first wall is hit, End if nothing is hit
+	bool RaycastWalls(const FVector& Start, const FVector& End, FVector& OutHitLocation) const;
+
+	// Cells from StartCell to EndCell through open walls, A* over the cell graph
+	UFUNCTION(BlueprintCallable, Category = "Grid Queries")
+	bool FindCellPath(int32 StartCell, int32 EndCell, TArray<int32>& OutCells) const;
+
+	// Path points through the middle of the rings & openings. One end can be outside, the path then uses the nearest perimeter opening.
+	UFUNCTION(BlueprintCallable, Category = "Grid Queries")
+	bool FindPathPoints(FVector Start, FVector End, TArray<FVector>& OutPoints) const;
+
+	UFUNCTION(BlueprintPure, Category = "Grid Queries")
+	FVector GetCellWorldLocation(int32 CellIndex) const;
+
+	// Nearest point of the cell to a world location, kept off its walls & at the cell height
+	FVector ClampToCell(const FVector& WorldLocation, int32 CellIndex) const;
+
+	float GetOuterRadius() const { return BaseRadius + Layout.GetOuterRing() * RingSpacing; }
+
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+	virtual void PreReplication(IRepChangedPropertyTracker& ChangedPropertyTracker) override;
+
+	const FLabyrinthLayout& GetLayout() const { return Layout; }
+	const TBitArray<>& GetWalls() const { return Generator.Walls; }
+
+protected:
+	UPROPERTY(ReplicatedUsing = OnRep_NetState)
+	FLabyrinthNetState NetState;
+
+	UFUNCTION()
+	void OnRep_NetState();
+
+	UFUNCTION(NetMulticast, Reliable)
+	void MulticastApplyWallDeltas(const FLabyrinthWallDeltas& Deltas);
+
+	// Wall bits & params of the baked labyrinth
+	UPROPERTY()
+	TArray<uint8> BakedWalls;
+
+	UPROPERTY()
+	FLabyrinthGenerationParams BakedParams;
+
+	// Checksum of the walls the saved instances were built from, a bake refreshed on save rebuilds them at load
+	UPROPERTY()
+	uint32 WallInstancesChecksum = 0;
 
 private:
 	
 	TArray<UTextRenderComponent*> InstancedTextRenderComponents;
 	FTimerHandle TimerHandleBacktracking;
 
-	FLabyrinthCell CurrentPathCell;
-	FLabyrinthCell NextPathCell;
+	FLabyrinthLayout Layout;
+	FLabyrinthGenerator Generator;
 
-	TArray<FLabyrinthCell> PathStackCells;
+	// Wall slot to CircularWalls instance and back, INDEX_NONE for open walls
+	TArray<int32> WallInstances;
+	TArray<int32> InstanceWalls;
+	int32 NumAppliedOpenedWalls = 0;
 
-	int32 LongestPath;
-	FLabyrinthCell LongestPathCell;
+	bool bLayoutReady = false;
+	bool bWallsEditedAtRuntime = false;
+	bool bNetStateDirty = false;
+	bool bWaitingForAuthorityWalls = false;
 
 	void GenerateGrid();
 	void GenerateGeometry();
-	void CalculateCellNeighbors(FLabyrinthCell& Cell);
+	void RestoreRuntimeState();
+	void RestoreWallInstances();
+	void BakeGeneration();
+	bool LoadBakedLabyrinth();
 	void ClearVariables();
-	int32 GetCurrentCell();
-	int32 GetRingSubdivision(int32 Ring);
+	int32 GetRingSubdivision(int32 Ring) const;
+
+	FTransform GetWallTransform(int32 WallIndex) const;
+	void BuildWallGeometry();
+	void BuildSymmetricWallGeometry(TArray<FTransform>& OutTransforms);
+	void AddWallInstance(int32 WallIndex);
+	void RemoveWallInstance(int32 WallIndex);
+	void ApplyOpenedWalls();
+	void SetWallState(int32 WallIndex, bool bOpen);
+
+	FLabyrinthGenerationParams MakeGenerationParams() const;
+	void ApplyGenerationParams(const FLabyrinthGenerationParams& Params);
+	void RefreshNetState();
+	void RequestAuthorityWalls();
 
 	bool RecursiveBacktrackingFinished = false;
 	
 	FVector PolarToCartesian(float Radius, float Angle) const;
+
+	bool GetCellAtLocalPoint(const FVector2D& LocalPoint, FLabyrinthCellCoord& OutCell) const;
+	bool FindWallOnLocalSegment(const FVector2D& Start, const FVector2D& End, int32& OutWallIndex, double& OutHitTime) const;
+	bool FindNearestPerimeterOpening(const FVector2D& LocalPoint, int32& OutCellIndex, int32& OutSegment) const;
+	void InvalidateNavigationPaths() const;
 	
 	FVector CalculateCellLocation(int32 Ring, int32 Sector) const;
 	void UpdateCellLocations();
 
 	void AddDebugTextRenderer(FVector TextLoc, FString TextMessage);
 
-	void SetLabyrinthEntrance(ELabyrinthStart ELabyrinthEntrance);
-	void SetLabyrinthExit(ELabyrinthExit ELabyrinthExit);
-	
-	int32 GetRandomPerimeterCell();
-	void RemoveWall(FLabyrinthCell Cell1, FLabyrinthCell Cell2);
-	bool GetPotentialNextNeighbor(FLabyrinthCell Cell, FLabyrinthCell& ChosenNeighbors);
-	void OpenPerimeterCell(FLabyrinthCell Cell);
 	void UpdatePathLocalisation(FLabyrinthCell Cell);
+	void UpdatePathStack(int32 NumBacktracked);
 	void UpdateCurrentVisitedState(int32 CellIndex, bool Current, bool Visited);
 
-	void FoundLongestPathAtRing(int32 Ring);
-	void OpenCenterCell(FLabyrinthCell Cell);
-
 	void StartRecursiveBacktracking();
 	void RecursiveBacktrackingStep();
-	
-
-	void ProgressPath();
 };
 
 
@@ -0,0 +1,94 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "LabyrinthLayout.h"
+#include "SLabyrinthGenerationParams.h"
+
+// What happened during one step of the recursive backtracking
+struct FLabyrinthGenerationStep
+{
+	// cell the path stands on at the end of the step
+	int32 PathCell = INDEX_NONE;
+
+	// cell the path moved to, INDEX_NONE if the step only backtracked
+	int32 NextCell = INDEX_NONE;
+
+	// number of cells popped from the backtracking stack before moving on
+	int32 NumBacktracked = 0;
+};
+
+/**
+ * Recursive backtracking over a FLabyrinthLayout driven by the seeded stream, so the same params give the same walls
+ * whether it runs animated, headless or on a client. The stream picks with float math, clients check the walls checksum.
+ */
+struct CIRCULARLABYRINTH_API FLabyrinthGenerator
+{
+	void Begin(const FLabyrinthLayout& InLayout, const FLabyrinthGenerationParams& InParams);
+
+	// Progress the path by one cell, backtracking as much as needed. Opens the exit once the stack is empty.
+	void Step(FLabyrinthGenerationStep& OutStep);
+
+	// Run the whole generation at once
+	void Run();
+
+	// Restore an already generated labyrinth without running the generation
+	void Load(const FLabyrinthLayout& InLayout, const FLabyrinthGenerationParams& InParams, const TBitArray<>& InWalls, int32 InEntranceCell, int32 InExitCell);
+
+	// Every wall standing & nothing generated, the state before Begin
+	void Reset(const FLabyrinthLayout& InLayout);
+
+	bool IsFinished() const { return bFinished; }
+
+	// Wedges the walls repeat over, 1 without symmetry
+	int32 GetNumWedges() const { return NumWedges; }
+
+	const FLabyrinthLayout& GetLayout() const { return *Layout; }
+	const FLabyrinthGenerationParams& GetParams() const { return Params; }
+
+	// Wall slots, a set bit is a standing wall
+	TBitArray<> Walls;
+	TBitArray<> Visited;
+
+	// Walls opened since Begin in opening order, used to replay the carving on geometry
+	TArray<int32> OpenedWalls;
+
+	// Cells the path moved from, top is the last one
+	TArray<int32> PathStack;
+
+	int32 CurrentCell = 0;
+	int32 EntranceCell = INDEX_NONE;
+	int32 ExitCell = INDEX_NONE;
+
+	// Byte packing of the wall bits, used to send or store them
+	static void PackWalls(const TBitArray<>& InWalls, TArray<uint8>& OutBytes);
+	static bool UnpackWalls(const TArray<uint8>& InBytes, int32 NumWalls, TBitArray<>& OutWalls);
+	static uint32 GetWallsChecksum(const TBitArray<>& InWalls);
+
+private:
+	int32 GetRandomPerimeterCell();
+	int32 GetPotentialNextNeighbor(int32 CellIndex);
+	void OpenWall(int32 WallIndex);
+	void OpenPerimeterCell(int32 CellIndex);
+	void FoundLongestPathAtRing(int32 CellIndex, int32 Ring);
+	void OpenExit();
+
+	void InitWedges();
+	void OpenCarvedWall(int32 WallIndex);
+	void JoinWedges();
+	int32 FindFarthestCell(int32 FromCell, int32 Ring);
+
+	const FLabyrinthLayout* Layout = nullptr;
+	FLabyrinthGenerationParams Params;
+	FRandomStream Stream;
+
+	int32 LongestPath = 0;
+	int32 LongestPathCell = INDEX_NONE;
+
+	int32 NumWedges = 1;
+	TArray<int32> SearchQueue;
+	TBitArray<> SearchReached;
+
+	bool bFinished = false;
+};
@@ -0,0 +1,76 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Ring / sector topology of a circular labyrinth, without any world or actor.
+ * Cells are indexed ring by ring starting at the center cell. Every non center cell owns two wall slots
+ * (its inner circular wall and the radial wall on its left edge), the perimeter segments come last.
+ */
+struct CIRCULARLABYRINTH_API FLabyrinthLayout
+{
+	void Init(int32 InMaxRings, int32 InSubdivisionFactor);
+
+	int32 GetMaxRings() const { return MaxRings; }
+	int32 GetSubdivisionFactor() const { return SubdivisionFactor; }
+	int32 GetNumCells() const { return CellRings.Num(); }
+	int32 GetNumWalls() const { return (GetNumCells() - 1) * 2 + GetNumPerimeterWalls(); }
+	int32 GetNumPerimeterWalls() const { return GetRingSubdivision(MaxRings); }
+
+	// formula to get subdivision at a ring with the subdivision factor
+	int32 GetRingSubdivision(int32 Ring) const { return 1 << (FMath::FloorLog2(Ring) + SubdivisionFactor); }
+
+	int32 GetCellIndex(int32 Ring, int32 Sector) const { return Ring == 0 ? 0 : RingFirstCell[Ring] + (Sector % GetRingSubdivision(Ring)); }
+	int32 GetCellRing(int32 CellIndex) const { return CellRings[CellIndex]; }
+	int32 GetCellSector(int32 CellIndex) const { return CellIndex - RingFirstCell[CellRings[CellIndex]]; }
+	int32 GetRingFirstCell(int32 Ring) const { return RingFirstCell[Ring]; }
+	int32 GetOuterRing() const { return MaxRings - 1; }
+
+	TConstArrayView<int32> GetNeighbors(int32 CellIndex) const
+	{
+		return TConstArrayView<int32>(Neighbors.GetData() + NeighborOffsets[CellIndex], NeighborOffsets[CellIndex + 1] - NeighborOffsets[CellIndex]);
+	}
+
+	// Wall slots
+	int32 GetInnerWall(int32 CellIndex) const { return (CellIndex - 1) * 2; }
+	int32 GetRadialWall(int32 CellIndex) const { return (CellIndex - 1) * 2 + 1; }
+	int32 GetPerimeterWall(int32 Segment) const { return (GetNumCells() - 1) * 2 + Segment; }
+	bool IsPerimeterWall(int32 WallIndex) const { return WallIndex >= (GetNumCells() - 1) * 2; }
+
+	// Cell owning an inner or radial wall slot, INDEX_NONE for perimeter walls
+	int32 GetWallCell(int32 WallIndex) const { return IsPerimeterWall(WallIndex) ? INDEX_NONE : WallIndex / 2 + 1; }
+	bool IsRadialWall(int32 WallIndex) const { return !IsPerimeterWall(WallIndex) && (WallIndex & 1) != 0; }
+
+	// Wall separating two neighbor cells
+	int32 GetWallBetween(int32 CellA, int32 CellB) const;
+
+	// Wall crossed going to the neighbor at NeighborSlot of GetNeighbors. On a ring of two sectors the left & right
+	// neighbors are the same cell behind two different walls, walks over the open walls must go through this one.
+	int32 GetNeighborWall(int32 CellIndex, int32 NeighborSlot) const;
+
+	// Cells on both sides of an inner or radial wall, false for perimeter walls
+	bool GetWallCells(int32 WallIndex, int32& OutCellA, int32& OutCellB) const;
+
+	// Perimeter segments in front of an outer ring cell (the perimeter can be twice as subdivided as the outer ring)
+	void GetPerimeterWalls(int32 CellIndex, int32& OutFirstWall, int32& OutNumWalls) const;
+
+	// Symmetry wedges, NumWedges is a power of two no bigger than the first ring subdivision so every ring splits evenly
+	bool IsInFirstWedge(int32 CellIndex, int32 NumWedges) const { return CellIndex != 0 && GetCellSector(CellIndex) < GetRingSubdivision(CellRings[CellIndex]) / NumWedges; }
+
+	// Same cell or wall slot turned by Wedge wedges around the center
+	int32 GetRotatedCell(int32 CellIndex, int32 Wedge, int32 NumWedges) const;
+	int32 GetRotatedWall(int32 WallIndex, int32 Wedge, int32 NumWedges) const;
+
+private:
+	int32 MaxRings = 0;
+	int32 SubdivisionFactor = 0;
+
+	TArray<int32> RingFirstCell;
+	TArray<int32> CellRings;
+
+	// neighbors of every cell packed in a single array, in the same order as the actor grid
+	TArray<int32> NeighborOffsets;
+	TArray<int32> Neighbors;
+};
@@ -0,0 +1,40 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "LabyrinthGenerator.h"
+#include "SLabyrinthMetrics.h"
+
+// Scores a generated labyrinth with one breadth first walk of its open walls from the entrance
+struct CIRCULARLABYRINTH_API FLabyrinthMetricsCalculator
+{
+	// Buffers are kept between calls, reuse the same calculator for many labyrinths
+	void Compute(const FLabyrinthGenerator& Generator, FLabyrinthMetrics& OutMetrics);
+
+private:
+	// open passages as pairs of cells, then packed per cell
+	TArray<int32> Passages;
+	TArray<int32> Degrees;
+	TArray<int32> LinkOffsets;
+	TArray<int32> Links;
+
+	TArray<int32> Parents;
+	TArray<int32> Queue;
+};
+
+struct FLabyrinthSeedSearchSettings
+{
+	// the seed is ignored, every other param stays fixed during the search
+	FLabyrinthGenerationParams Params;
+
+	int32 FirstSeed = 0;
+	int64 NumSeeds = 1000000;
+
+	int32 MaxResults = 32;
+
+	FLabyrinthMetricsTargets Targets;
+};
+
+// Generates & scores seeds on every core, returns the lowest seeds matching the targets
+CIRCULARLABYRINTH_API void SearchLabyrinthSeeds(const FLabyrinthSeedSearchSettings& Settings, TArray<FLabyrinthSeedSearchResult>& OutResults);
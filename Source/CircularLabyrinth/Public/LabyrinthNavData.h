@@ -0,0 +1,63 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "NavigationData.h"
+#include "LabyrinthNavData.generated.h"
+
+class ACircularGrid;
+
+/**
+ * Navigation data reading the carved cell graph of the labyrinths directly, one node per cell and open walls as edges.
+ * Nothing is built, the graph is the labyrinth itself. Add this class to the supported agents of the navigation system
+ * and turn off bWallsAffectNavigation on the labyrinths so no navmesh gets rebuilt around the wall instances.
+ * Paths with both ends outside of every labyrinth are straight lines, but only points inside a labyrinth project on the graph.
+ * The labyrinths change their walls on the game thread, so every query runs there and async path queries fail.
+ */
+UCLASS()
+class CIRCULARLABYRINTH_API ALabyrinthNavData : public ANavigationData
+{
+	GENERATED_BODY()
+
+public:
+	ALabyrinthNavData();
+
+	// Paths found before a wall change get a repath
+	void InvalidateActivePaths();
+
+	// Labyrinths the queries run on, so no query iterates the world
+	void RegisterLabyrinth(const ACircularGrid* Labyrinth);
+	void UnregisterLabyrinth(const ACircularGrid* Labyrinth);
+
+	virtual void PostRegisterAllComponents() override;
+
+	static FPathFindingResult FindPath(const FNavAgentProperties& AgentProperties, const FPathFindingQuery& Query);
+	static bool Raycast(const ANavigationData* NavDataInstance, const FVector& RayStart, const FVector& RayEnd, FVector& HitLocation, FSharedConstNavQueryFilter QueryFilter, const UObject* Querier);
+
+	virtual FBox GetBounds() const override;
+
+	virtual FNavLocation GetRandomPoint(FSharedConstNavQueryFilter Filter = nullptr, const UObject* Querier = nullptr) const override;
+	virtual bool GetRandomReachablePointInRadius(const FVector& Origin, float Radius, FNavLocation& OutResult, FSharedConstNavQueryFilter Filter = nullptr, const UObject* Querier = nullptr) const override;
+	virtual bool GetRandomPointInNavigableRadius(const FVector& Origin, float Radius, FNavLocation& OutResult, FSharedConstNavQueryFilter Filter = nullptr, const UObject* Querier = nullptr) const override;
+
+	virtual bool ProjectPoint(const FVector& Point, FNavLocation& OutLocation, const FVector& Extent, FSharedConstNavQueryFilter Filter = nullptr, const UObject* Querier = nullptr) const override;
+	virtual void BatchProjectPoints(TArray<FNavigationProjectionWork>& Workload, const FVector& Extent, FSharedConstNavQueryFilter Filter = nullptr, const UObject* Querier = nullptr) const override;
+	virtual void BatchProjectPoints(TArray<FNavigationProjectionWork>& Workload, FSharedConstNavQueryFilter Filter = nullptr, const UObject* Querier = nullptr) const override;
+
+	virtual ENavigationQueryResult::Type CalcPathCost(const FVector& PathStart, const FVector& PathEnd, FVector::FReal& OutPathCost, FSharedConstNavQueryFilter QueryFilter = nullptr, const UObject* Querier = nullptr) const override;
+	virtual ENavigationQueryResult::Type CalcPathLength(const FVector& PathStart, const FVector& PathEnd, FVector::FReal& OutPathLength, FSharedConstNavQueryFilter QueryFilter = nullptr, const UObject* Querier = nullptr) const override;
+	virtual ENavigationQueryResult::Type CalcPathLengthAndCost(const FVector& PathStart, const FVector& PathEnd, FVector::FReal& OutPathLength, FVector::FReal& OutPathCost, FSharedConstNavQueryFilter QueryFilter = nullptr, const UObject* Querier = nullptr) const override;
+
+	virtual bool DoesNodeContainLocation(NavNodeRef NodeRef, const FVector& WorldSpaceLocation) const override;
+	virtual void BatchRaycast(TArray<FNavigationRaycastWork>& Workload, FSharedConstNavQueryFilter QueryFilter, const UObject* Querier = nullptr) const override;
+	virtual bool FindMoveAlongSurface(const FNavLocation& StartLocation, const FVector& TargetPosition, FNavLocation& OutLocation, FSharedConstNavQueryFilter Filter = nullptr, const UObject* Querier = nullptr) const override;
+
+private:
+	void GetLabyrinths(TArray<const ACircularGrid*, TInlineAllocator<4>>& OutLabyrinths) const;
+
+	// Labyrinth a path between two points goes through, the one holding the start first
+	const ACircularGrid* FindLabyrinth(const FVector& Start, const FVector& End) const;
+
+	TArray<TWeakObjectPtr<const ACircularGrid>> Labyrinths;
+};
@@ -0,0 +1,39 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "SLabyrinthNetState.h"
+#include "LabyrinthNetRelay.generated.h"
+
+class ACircularGrid;
+class APlayerController;
+
+/**
+ * Added by the server to every player controller. Labyrinths are level actors no client owns, so a client
+ * whose regenerated walls don't match the authority checksum asks for the wall bits through its own relay.
+ */
+UCLASS()
+class CIRCULARLABYRINTH_API ULabyrinthNetRelay : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	ULabyrinthNetRelay();
+
+	virtual void BeginPlay() override;
+
+	// Server only, gives a relay to the current & future players
+	static void AddToPlayers(UWorld* World);
+	static void AddToPlayer(APlayerController* PlayerController);
+
+	// Relay of the local player, null until it replicated
+	static ULabyrinthNetRelay* FindLocal(const UWorld* World);
+
+	UFUNCTION(Server, Reliable)
+	void ServerRequestWalls(ACircularGrid* Labyrinth);
+
+	UFUNCTION(Client, Reliable)
+	void ClientReceiveWalls(ACircularGrid* Labyrinth, const FLabyrinthNetState& State);
+};
@@ -0,0 +1,68 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "LabyrinthGenerator.h"
+
+enum class ELabyrinthDefect : uint8
+{
+	None,
+	AsymmetricNeighbors,	// a cell is not in the neighbors of one of its neighbors
+	UnrelatedWall,			// the wall between two neighbors belongs to neither of them
+	OneWayWall,				// a wall can't be crossed from both of its cells walking the neighbors
+	Cycle,					// an open wall joins two already connected cells
+	Disconnected,			// some cells can't be reached
+	ClosedEntrance,
+	ClosedExit,
+};
+
+CIRCULARLABYRINTH_API const TCHAR* LexToString(ELabyrinthDefect Defect);
+
+// Checks a generated labyrinth is perfect: every cell connected, no loop, entrance & exit open
+struct CIRCULARLABYRINTH_API FLabyrinthValidator
+{
+	// Union find over the open walls, buffers are kept between calls
+	ELabyrinthDefect Validate(const FLabyrinthGenerator& Generator);
+
+	// Only depends on the layout, worth running once per MaxRings / SubdivisionFactor
+	static ELabyrinthDefect ValidateNeighbors(const FLabyrinthLayout& Layout);
+
+private:
+	int32 FindRoot(int32 CellIndex);
+
+	TArray<int32> Parents;
+};
+
+struct FLabyrinthFuzzSettings
+{
+	int64 NumIterations = 1000000;
+	int32 FirstSeed = 0;
+
+	int32 MinRings = 2;
+	int32 MaxRings = 16;
+	int32 MaxSubdivisionFactor = 4;
+
+	int32 MaxReportedFailures = 16;
+};
+
+struct FLabyrinthFuzzFailure
+{
+	// smallest labyrinth found with the same seed, start & exit that still fails
+	FLabyrinthGenerationParams Params;
+	ELabyrinthDefect Defect = ELabyrinthDefect::None;
+
+	// params the failure was first found with
+	FLabyrinthGenerationParams OriginalParams;
+};
+
+struct FLabyrinthFuzzStats
+{
+	int64 NumIterations = 0;
+	int64 NumCells = 0;
+	int64 NumFailures = 0;
+	double Seconds = 0.0;
+};
+
+// Generates & validates random seeds and parameter sets on every core, without any actor
+CIRCULARLABYRINTH_API void FuzzLabyrinths(const FLabyrinthFuzzSettings& Settings, TArray<FLabyrinthFuzzFailure>& OutFailures, FLabyrinthFuzzStats& OutStats);
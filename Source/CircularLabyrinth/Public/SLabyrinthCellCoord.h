@@ -0,0 +1,21 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SLabyrinthCellCoord.generated.h"
+
+USTRUCT(BlueprintType)
+struct FLabyrinthCellCoord
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly)
+	int32 Ring = 0;
+
+	UPROPERTY(BlueprintReadOnly)
+	int32 Sector = 0;
+
+	UPROPERTY(BlueprintReadOnly)
+	int32 Index = 0;
+};
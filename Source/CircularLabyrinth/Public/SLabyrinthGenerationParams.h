@@ -0,0 +1,86 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ELabyrinthExit.h"
+#include "ELabyrinthStart.h"
+#include "SLabyrinthGenerationParams.generated.h"
+
+// Everything the generation depends on, two labyrinths with the same params carve the same walls
+USTRUCT(BlueprintType)
+struct FLabyrinthGenerationParams
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	int32 MaxRings = 3;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	int32 SubdivisionFactor = 1;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	int32 Seed = 0;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	ELabyrinthStart StartPath = ELabyrinthStart::Center;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	ELabyrinthExit EndPath = ELabyrinthExit::Center;
+
+	// k-fold rotational symmetry, a power of two. Only a 1/k wedge is carved then copied around the center.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	int32 SymmetryFold = 1;
+
+	// Passages opened on the seams between two wedges, more than one makes loops
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	int32 SymmetrySeamOpenings = 1;
+
+	bool operator==(const FLabyrinthGenerationParams& Other) const
+	{
+		return MaxRings == Other.MaxRings && SubdivisionFactor == Other.SubdivisionFactor && Seed == Other.Seed
+			&& StartPath == Other.StartPath && EndPath == Other.EndPath
+			&& SymmetryFold == Other.SymmetryFold && SymmetrySeamOpenings == Other.SymmetrySeamOpenings;
+	}
+
+	bool operator!=(const FLabyrinthGenerationParams& Other) const { return !(*this == Other); }
+
+	bool NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess)
+	{
+		uint32 PackedRings = MaxRings;
+		uint32 PackedSubdivision = SubdivisionFactor;
+		uint8 PackedPaths = static_cast<uint8>(StartPath) | (static_cast<uint8>(EndPath) << 4);
+		uint32 PackedFold = SymmetryFold;
+		uint32 PackedSeamOpenings = SymmetrySeamOpenings;
+
+		Ar.SerializeIntPacked(PackedRings);
+		Ar.SerializeIntPacked(PackedSubdivision);
+		Ar << Seed;
+		Ar << PackedPaths;
+		Ar.SerializeIntPacked(PackedFold);
+		Ar.SerializeIntPacked(PackedSeamOpenings);
+
+		if (Ar.IsLoading())
+		{
+			MaxRings = PackedRings;
+			SubdivisionFactor = PackedSubdivision;
+			StartPath = static_cast<ELabyrinthStart>(PackedPaths & 0x0F);
+			EndPath = static_cast<ELabyrinthExit>(PackedPaths >> 4);
+			SymmetryFold = PackedFold;
+			SymmetrySeamOpenings = PackedSeamOpenings;
+		}
+
+		bOutSuccess = true;
+		return true;
+	}
+};
+
+template<>
+struct TStructOpsTypeTraits<FLabyrinthGenerationParams> : public TStructOpsTypeTraitsBase2<FLabyrinthGenerationParams>
+{
+	enum
+	{
+		WithNetSerializer = true,
+		WithIdenticalViaEquality = true,
+	};
+};
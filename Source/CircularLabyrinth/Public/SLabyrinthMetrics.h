@@ -0,0 +1,91 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SLabyrinthMetrics.generated.h"
+
+// How a generated labyrinth plays, computed from its open walls
+USTRUCT(BlueprintType)
+struct FLabyrinthMetrics
+{
+	GENERATED_BODY()
+
+	// cells walked from the entrance to the exit, both included
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	int32 SolutionLength = 0;
+
+	// cells with a single opening, entrance & exit excluded
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	int32 NumDeadEnds = 0;
+
+	// average ways forward from a cell that isn't a dead end, 1 is a single corridor
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	float BranchingFactor = 0.0f;
+
+	// average number of cells in a run of cells with exactly two openings
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	float AverageCorridorLength = 0.0f;
+
+	// average size in cells of the branches leaving the solution, few long branches give a high river factor
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	float RiverFactor = 0.0f;
+};
+
+// Accepted range of every metric, a labyrinth matches when all of them are in range
+USTRUCT(BlueprintType)
+struct FLabyrinthMetricsTargets
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	int32 MinSolutionLength = 0;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	int32 MaxSolutionLength = MAX_int32;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	int32 MinDeadEnds = 0;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	int32 MaxDeadEnds = MAX_int32;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float MinBranchingFactor = 0.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float MaxBranchingFactor = 100.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float MinAverageCorridorLength = 0.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float MaxAverageCorridorLength = 10000.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float MinRiverFactor = 0.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float MaxRiverFactor = 10000.0f;
+
+	bool Matches(const FLabyrinthMetrics& Metrics) const
+	{
+		return Metrics.SolutionLength >= MinSolutionLength && Metrics.SolutionLength <= MaxSolutionLength
+			&& Metrics.NumDeadEnds >= MinDeadEnds && Metrics.NumDeadEnds <= MaxDeadEnds
+			&& Metrics.BranchingFactor >= MinBranchingFactor && Metrics.BranchingFactor <= MaxBranchingFactor
+			&& Metrics.AverageCorridorLength >= MinAverageCorridorLength && Metrics.AverageCorridorLength <= MaxAverageCorridorLength
+			&& Metrics.RiverFactor >= MinRiverFactor && Metrics.RiverFactor <= MaxRiverFactor;
+	}
+};
+
+USTRUCT(BlueprintType)
+struct FLabyrinthSeedSearchResult
+{
+	GENERATED_BODY()
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	int32 Seed = 0;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	FLabyrinthMetrics Metrics;
+};
@@ -0,0 +1,139 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SLabyrinthGenerationParams.h"
+#include "SLabyrinthNetState.generated.h"
+
+// Full labyrinth state sent once to every client when the actor channel opens
+USTRUCT()
+struct FLabyrinthNetState
+{
+	GENERATED_BODY()
+
+	// clients regenerate the labyrinth from these params
+	UPROPERTY()
+	FLabyrinthGenerationParams Params;
+
+	// checksum of the authority walls, lets clients check their regeneration
+	UPROPERTY()
+	uint32 WallsChecksum = 0;
+
+	// compressed wall bits, only filled when the walls can't be regenerated from the params
+	UPROPERTY()
+	TArray<uint8> CompressedWalls;
+
+	UPROPERTY()
+	int32 UncompressedSize = 0;
+
+	// entrance & exit go with the wall bits, they aren't known without running the generation
+	UPROPERTY()
+	int32 EntranceCell = INDEX_NONE;
+
+	UPROPERTY()
+	int32 ExitCell = INDEX_NONE;
+
+	static constexpr uint32 MaxNetBytes = 1 << 20;
+
+	bool NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess)
+	{
+		Params.NetSerialize(Ar, Map, bOutSuccess);
+		Ar << WallsChecksum;
+
+		uint32 NumCompressed = CompressedWalls.Num();
+		uint32 PackedUncompressedSize = UncompressedSize;
+		uint32 PackedEntranceCell = EntranceCell + 1; // INDEX_NONE packs as 0
+		uint32 PackedExitCell = ExitCell + 1;
+		Ar.SerializeIntPacked(NumCompressed);
+		if (NumCompressed > 0)
+		{
+			Ar.SerializeIntPacked(PackedUncompressedSize);
+			Ar.SerializeIntPacked(PackedEntranceCell);
+			Ar.SerializeIntPacked(PackedExitCell);
+		}
+
+		if (Ar.IsLoading())
+		{
+			if (NumCompressed > MaxNetBytes)
+			{
+				Ar.SetError();
+				bOutSuccess = false;
+				return true;
+			}
+			CompressedWalls.SetNumUninitialized(NumCompressed);
+			UncompressedSize = NumCompressed > 0 ? PackedUncompressedSize : 0;
+			EntranceCell = NumCompressed > 0 ? static_cast<int32>(PackedEntranceCell) - 1 : INDEX_NONE;
+			ExitCell = NumCompressed > 0 ? static_cast<int32>(PackedExitCell) - 1 : INDEX_NONE;
+		}
+		Ar.Serialize(CompressedWalls.GetData(), NumCompressed);
+
+		bOutSuccess = !Ar.IsError();
+		return true;
+	}
+};
+
+template<>
+struct TStructOpsTypeTraits<FLabyrinthNetState> : public TStructOpsTypeTraitsBase2<FLabyrinthNetState>
+{
+	enum
+	{
+		WithNetSerializer = true,
+	};
+};
+
+// Runtime wall changes, every entry is a wall index shifted left by one with the open state in the low bit
+USTRUCT()
+struct FLabyrinthWallDeltas
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TArray<uint32> PackedWalls;
+
+	static constexpr uint32 MaxNetWalls = 1 << 16;
+
+	void Add(int32 WallIndex, bool bOpen) { PackedWalls.Add((static_cast<uint32>(WallIndex) << 1) | (bOpen ? 1 : 0)); }
+
+	static int32 GetWallIndex(uint32 PackedWall) { return static_cast<int32>(PackedWall >> 1); }
+	static bool IsOpen(uint32 PackedWall) { return (PackedWall & 1) != 0; }
+
+	bool NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess)
+	{
+		uint32 NumWalls = PackedWalls.Num();
+		Ar.SerializeIntPacked(NumWalls);
+
+		if (Ar.IsLoading())
+		{
+			if (NumWalls > MaxNetWalls)
+			{
+				Ar.SetError();
+				bOutSuccess = false;
+				return true;
+			}
+			PackedWalls.SetNumUninitialized(NumWalls);
+		}
+
+		// walls are sent sorted as packed deltas, close indices cost a single byte
+		uint32 PreviousWall = 0;
+		for (uint32& PackedWall : PackedWalls)
+		{
+			uint32 Delta = PackedWall - PreviousWall;
+			Ar.SerializeIntPacked(Delta);
+			PackedWall = PreviousWall + Delta;
+			PreviousWall = PackedWall;
+		}
+
+		bOutSuccess = !Ar.IsError();
+		return true;
+	}
+};
+
+template<>
+struct TStructOpsTypeTraits<FLabyrinthWallDeltas> : public TStructOpsTypeTraitsBase2<FLabyrinthWallDeltas>
+{
+	enum
+	{
+		WithNetSerializer = true,
+	};
+};